@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include "barneshutsolver2d.h"
+
+
+BarnesHutSolver2D::BarnesHutSolver2D(ThreadPool& thread_pool, float attraction, float radius, float theta) :
+    m_thread_pool(thread_pool),
+    m_attraction(attraction),
+    m_radius(radius),
+    m_theta(theta)
+{
+}
+
+
+void BarnesHutSolver2D::computeAccelerations(const std::vector<float>& pos_x, const std::vector<float>& pos_y,
+    const std::vector<float>& mass, std::vector<float>& acc_x, std::vector<float>& acc_y)
+{
+    acc_x.resize(pos_x.size());
+    acc_y.resize(pos_y.size());
+
+    if (pos_x.empty()) {
+        return;
+    }
+
+    buildTree(pos_x, pos_y, mass);
+
+    // walk in tree order so that neighbouring threads visit the same nodes
+    m_thread_pool.parallelFor(m_indices.size(), [this, &acc_x, &acc_y](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            walkTree(static_cast<uint32_t>(i), acc_x[m_indices[i]], acc_y[m_indices[i]]);
+        }
+    });
+}
+
+
+void BarnesHutSolver2D::buildTree(const std::vector<float>& pos_x, const std::vector<float>& pos_y, const std::vector<float>& mass)
+{
+    auto [min_x, max_x] = std::minmax_element(pos_x.begin(), pos_x.end());
+    auto [min_y, max_y] = std::minmax_element(pos_y.begin(), pos_y.end());
+    float half_size = std::max(*max_x - *min_x, *max_y - *min_y) / 2.0f;
+
+    m_indices.resize(pos_x.size());
+    std::iota(m_indices.begin(), m_indices.end(), 0);
+
+    m_nodes.clear();
+    m_nodes.push_back(Node{ 0.0f, 0.0f, 0.0f, 0.0f, NO_CHILD, 0, 0, static_cast<uint32_t>(pos_x.size()) });
+    buildNode(pos_x, pos_y, mass, 0, (*min_x + *max_x) / 2.0f, (*min_y + *max_y) / 2.0f, half_size, 0);
+
+    m_sorted_x.resize(pos_x.size());
+    m_sorted_y.resize(pos_y.size());
+    m_sorted_mass.resize(mass.size());
+    for (size_t i = 0; i < m_indices.size(); i++) {
+        m_sorted_x[i] = pos_x[m_indices[i]];
+        m_sorted_y[i] = pos_y[m_indices[i]];
+        m_sorted_mass[i] = mass[m_indices[i]];
+    }
+}
+
+
+void BarnesHutSolver2D::buildNode(const std::vector<float>& pos_x, const std::vector<float>& pos_y, const std::vector<float>& mass,
+    uint32_t node_index, float center_x, float center_y, float half_size, uint32_t depth)
+{
+    const uint32_t begin = m_nodes[node_index].begin;
+    const uint32_t end = m_nodes[node_index].end;
+    m_nodes[node_index].size = half_size * 2.0f;
+
+    if ((end - begin <= MAX_LEAF_POINTS) || (depth == MAX_DEPTH)) {
+        float leaf_mass = 0.0f;
+        float sum_x = 0.0f;
+        float sum_y = 0.0f;
+        for (uint32_t i = begin; i < end; i++) {
+            leaf_mass += mass[m_indices[i]];
+            sum_x += mass[m_indices[i]] * pos_x[m_indices[i]];
+            sum_y += mass[m_indices[i]] * pos_y[m_indices[i]];
+        }
+
+        // massless points have no centre of mass, the centre of the square keeps the walk finite
+        m_nodes[node_index].mass = leaf_mass;
+        m_nodes[node_index].com_x = (leaf_mass > 0.0f) ? sum_x / leaf_mass : center_x;
+        m_nodes[node_index].com_y = (leaf_mass > 0.0f) ? sum_y / leaf_mass : center_y;
+        return;
+    }
+
+    // split the points into quadrants: (left bottom, left top, right bottom, right top)
+    auto first = m_indices.begin() + begin;
+    auto last = m_indices.begin() + end;
+    auto split_x = std::partition(first, last, [&pos_x, center_x](uint32_t i) { return pos_x[i] < center_x; });
+    auto split_y_left = std::partition(first, split_x, [&pos_y, center_y](uint32_t i) { return pos_y[i] < center_y; });
+    auto split_y_right = std::partition(split_x, last, [&pos_y, center_y](uint32_t i) { return pos_y[i] < center_y; });
+
+    const uint32_t bounds[5] = {
+        begin,
+        static_cast<uint32_t>(split_y_left - m_indices.begin()),
+        static_cast<uint32_t>(split_x - m_indices.begin()),
+        static_cast<uint32_t>(split_y_right - m_indices.begin()),
+        end
+    };
+
+    const uint32_t first_child = static_cast<uint32_t>(m_nodes.size());
+    uint32_t num_children = 0;
+    for (uint32_t quadrant = 0; quadrant < 4; quadrant++) {
+        if (bounds[quadrant] != bounds[quadrant + 1]) {
+            m_nodes.push_back(Node{ 0.0f, 0.0f, 0.0f, 0.0f, NO_CHILD, 0, bounds[quadrant], bounds[quadrant + 1] });
+            num_children++;
+        }
+    }
+
+    m_nodes[node_index].first_child = first_child;
+    m_nodes[node_index].num_children = num_children;
+
+    const float quarter_size = half_size / 2.0f;
+    uint32_t child_index = first_child;
+    for (uint32_t quadrant = 0; quadrant < 4; quadrant++) {
+        if (bounds[quadrant] != bounds[quadrant + 1]) {
+            float child_center_x = center_x + ((quadrant < 2) ? -quarter_size : quarter_size);
+            float child_center_y = center_y + ((quadrant % 2 == 0) ? -quarter_size : quarter_size);
+            buildNode(pos_x, pos_y, mass, child_index, child_center_x, child_center_y, quarter_size, depth + 1);
+            child_index++;
+        }
+    }
+
+    float node_mass = 0.0f;
+    float sum_x = 0.0f;
+    float sum_y = 0.0f;
+    for (uint32_t child = first_child; child < first_child + num_children; child++) {
+        node_mass += m_nodes[child].mass;
+        sum_x += m_nodes[child].mass * m_nodes[child].com_x;
+        sum_y += m_nodes[child].mass * m_nodes[child].com_y;
+    }
+
+    m_nodes[node_index].mass = node_mass;
+    m_nodes[node_index].com_x = (node_mass > 0.0f) ? sum_x / node_mass : center_x;
+    m_nodes[node_index].com_y = (node_mass > 0.0f) ? sum_y / node_mass : center_y;
+}
+
+
+void BarnesHutSolver2D::walkTree(uint32_t sorted_index, float& acc_x, float& acc_y) const
+{
+    const float pos_x = m_sorted_x[sorted_index];
+    const float pos_y = m_sorted_y[sorted_index];
+    const float theta_2 = m_theta * m_theta;
+    float sum_x = 0.0f;
+    float sum_y = 0.0f;
+
+    uint32_t stack[4 * MAX_DEPTH + 4];
+    uint32_t stack_size = 0;
+    stack[stack_size++] = 0;
+
+    while (stack_size > 0) {
+        const Node& node = m_nodes[stack[--stack_size]];
+
+        if (node.first_child == NO_CHILD) {
+            for (uint32_t j = node.begin; j < node.end; j++) {
+                if (j != sorted_index) {
+                    float dx = m_sorted_x[j] - pos_x;
+                    float dy = m_sorted_y[j] - pos_y;
+                    float dist = std::sqrt(dx * dx + dy * dy);
+                    if (dist > m_radius) {
+                        float factor = m_attraction * m_sorted_mass[j] / dist / dist / dist;
+                        sum_x += factor * dx;
+                        sum_y += factor * dy;
+                    }
+                }
+            }
+
+            continue;
+        }
+
+        float dx = node.com_x - pos_x;
+        float dy = node.com_y - pos_y;
+        float dist_2 = dx * dx + dy * dy;
+
+        if (node.size * node.size < theta_2 * dist_2) {
+            // far enough away to be treated as a single point
+            float dist = std::sqrt(dist_2);
+            if (dist > m_radius) {
+                float factor = m_attraction * node.mass / dist / dist / dist;
+                sum_x += factor * dx;
+                sum_y += factor * dy;
+            }
+
+            continue;
+        }
+
+        for (uint32_t child = node.first_child; child < node.first_child + node.num_children; child++) {
+            stack[stack_size++] = child;
+        }
+    }
+
+    acc_x = sum_x;
+    acc_y = sum_y;
+}
@@ -0,0 +1,47 @@
+#ifndef BARNESHUTSOLVER2D_H
+#define BARNESHUTSOLVER2D_H
+
+#include <cstdint>
+#include "forcesolver2d.h"
+
+// O(N log N) Barnes-Hut solver. Rebuilds a quadtree every call, walks it in parallel.
+class BarnesHutSolver2D : public ForceSolver2D {
+public:
+    BarnesHutSolver2D(ThreadPool& thread_pool, float attraction, float radius, float theta);
+
+    void computeAccelerations(const std::vector<float>& pos_x, const std::vector<float>& pos_y,
+        const std::vector<float>& mass, std::vector<float>& acc_x, std::vector<float>& acc_y) override;
+
+private:
+    static constexpr uint32_t MAX_LEAF_POINTS = 8;
+    static constexpr uint32_t MAX_DEPTH = 32;
+    static constexpr uint32_t NO_CHILD = 0xFFFFFFFF;
+
+    struct Node {
+        float com_x; // centre of mass
+        float com_y;
+        float mass;
+        float size; // edge length of the square
+        uint32_t first_child; // children are stored next to each other
+        uint32_t num_children;
+        uint32_t begin; // range of points in tree order
+        uint32_t end;
+    };
+
+    ThreadPool& m_thread_pool;
+    float m_attraction;
+    float m_radius;
+    float m_theta;
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_indices; // tree order -> point index
+    std::vector<float> m_sorted_x;
+    std::vector<float> m_sorted_y;
+    std::vector<float> m_sorted_mass;
+
+    void buildTree(const std::vector<float>& pos_x, const std::vector<float>& pos_y, const std::vector<float>& mass);
+    void buildNode(const std::vector<float>& pos_x, const std::vector<float>& pos_y, const std::vector<float>& mass,
+        uint32_t node_index, float center_x, float center_y, float half_size, uint32_t depth);
+    void walkTree(uint32_t sorted_index, float& acc_x, float& acc_y) const;
+};
+
+#endif // BARNESHUTSOLVER2D_H
@@ -0,0 +1,100 @@
+#include "commandprofiler.h"
+
+
+void CommandProfiler::setEnabled(bool enabled)
+{
+    m_enabled = enabled;
+}
+
+
+bool CommandProfiler::isEnabled() const
+{
+    return m_enabled;
+}
+
+
+cl::Event* CommandProfiler::track(const char* name, cl::Event* event)
+{
+    if (!m_enabled) {
+        return event;
+    }
+
+    if (event == nullptr) {
+        m_events.emplace_back();
+        event = &m_events.back();
+    }
+
+    m_commands.push_back({ name, event });
+    return event;
+}
+
+
+void CommandProfiler::collect()
+{
+    // totals of this batch, one entry per command name
+    std::vector<CommandStats> batch_stats;
+    for (const Command& command : m_commands) {
+        cl_int ocl_err[4];
+        const cl_ulong queued = command.event->getProfilingInfo<CL_PROFILING_COMMAND_QUEUED>(&ocl_err[0]);
+        const cl_ulong submit = command.event->getProfilingInfo<CL_PROFILING_COMMAND_SUBMIT>(&ocl_err[1]);
+        const cl_ulong start = command.event->getProfilingInfo<CL_PROFILING_COMMAND_START>(&ocl_err[2]);
+        const cl_ulong end = command.event->getProfilingInfo<CL_PROFILING_COMMAND_END>(&ocl_err[3]);
+
+        // some drivers do not time every kind of command, those are left out
+        if ((ocl_err[0] != CL_SUCCESS) || (ocl_err[1] != CL_SUCCESS) || (ocl_err[2] != CL_SUCCESS) || (ocl_err[3] != CL_SUCCESS)) {
+            continue;
+        }
+
+        auto stats = batch_stats.begin();
+        while ((stats != batch_stats.end()) && (stats->name != command.name)) {
+            stats++;
+        }
+
+        if (stats == batch_stats.end()) {
+            batch_stats.push_back(CommandStats{ command.name });
+            stats = batch_stats.end() - 1;
+        }
+
+        stats->launches += 1.0;
+        stats->queued_time += static_cast<double>(submit - queued) * 1.0e-9;
+        stats->submit_time += static_cast<double>(start - submit) * 1.0e-9;
+        stats->run_time += static_cast<double>(end - start) * 1.0e-9;
+    }
+
+    m_commands.clear();
+    m_events.clear();
+
+    for (CommandStats& batch : batch_stats) {
+        batch.queued_time /= batch.launches;
+        batch.submit_time /= batch.launches;
+
+        auto stats = m_stats.begin();
+        while ((stats != m_stats.end()) && (stats->name != batch.name)) {
+            stats++;
+        }
+
+        if (stats == m_stats.end()) {
+            m_stats.push_back(batch);
+            continue;
+        }
+
+        stats->launches += SMOOTHING * (batch.launches - stats->launches);
+        stats->queued_time += SMOOTHING * (batch.queued_time - stats->queued_time);
+        stats->submit_time += SMOOTHING * (batch.submit_time - stats->submit_time);
+        stats->run_time += SMOOTHING * (batch.run_time - stats->run_time);
+    }
+}
+
+
+void CommandProfiler::clear()
+{
+    m_commands.clear();
+    m_events.clear();
+    m_stats.clear();
+}
+
+
+const std::vector<CommandProfiler::CommandStats>& CommandProfiler::getStats() const
+{
+    return m_stats;
+}
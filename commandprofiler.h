@@ -0,0 +1,51 @@
+#ifndef COMMANDPROFILER_H
+#define COMMANDPROFILER_H
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#define CL_HPP_MINIMUM_OPENCL_VERSION 110
+#define CL_HPP_TARGET_OPENCL_VERSION 110
+#include <CL/cl2.hpp>
+
+// Rolling per-command timings of the simulation batches, read from the profiling info of their OpenCL events.
+// The command queue must have profiling enabled.
+class CommandProfiler {
+public:
+    struct CommandStats {
+        std::string name;
+        double launches = 0.0; // per batch
+        double queued_time = 0.0; // from queued to submitted, mean per launch [s]
+        double submit_time = 0.0; // from submitted to started, mean per launch [s]
+        double run_time = 0.0; // from started to ended, sum per batch [s]
+    };
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+
+    // Event to pass to an enqueue call. While enabled the command is recorded under name, in event if one is given
+    // or else in an event owned by the profiler. A given event must stay valid until the next collect.
+    cl::Event* track(const char* name, cl::Event* event = nullptr);
+
+    // Adds the commands recorded since the last call to the statistics, they must all have completed.
+    void collect();
+    // Drops the recorded commands and the statistics.
+    void clear();
+    const std::vector<CommandStats>& getStats() const;
+
+private:
+    static constexpr double SMOOTHING = 0.1; // weight of the latest batch
+
+    struct Command {
+        std::string name; // a copy, the caller's string may be gone by the next collect
+        cl::Event* event;
+    };
+
+    bool m_enabled = false;
+    std::vector<Command> m_commands;
+    std::deque<cl::Event> m_events; // stable addresses for the events handed out by track
+    std::vector<CommandStats> m_stats; // in order of first appearance
+};
+
+#endif // COMMANDPROFILER_H
@@ -0,0 +1,59 @@
+#include <cmath>
+#include <utility>
+#include "fft.h"
+
+
+Fft::Fft(size_t size) :
+    m_size(size),
+    m_bit_reversed(size),
+    m_twiddles(size / 2)
+{
+    size_t num_bits = 0;
+    while ((static_cast<size_t>(1) << num_bits) < size) {
+        num_bits++;
+    }
+
+    for (size_t i = 0; i < size; i++) {
+        size_t reversed = 0;
+        for (size_t bit = 0; bit < num_bits; bit++) {
+            reversed |= ((i >> bit) & 1) << (num_bits - 1 - bit);
+        }
+        m_bit_reversed[i] = reversed;
+    }
+
+    const double pi = std::acos(-1.0);
+    for (size_t k = 0; k < size / 2; k++) {
+        const double angle = -2.0 * pi * static_cast<double>(k) / static_cast<double>(size);
+        m_twiddles[k] = std::complex<double>(std::cos(angle), std::sin(angle));
+    }
+}
+
+
+size_t Fft::getSize() const
+{
+    return m_size;
+}
+
+
+void Fft::transform(std::complex<double>* data, bool inverse) const
+{
+    for (size_t i = 0; i < m_size; i++) {
+        if (i < m_bit_reversed[i]) {
+            std::swap(data[i], data[m_bit_reversed[i]]);
+        }
+    }
+
+    for (size_t length = 2; length <= m_size; length *= 2) {
+        const size_t half = length / 2;
+        const size_t twiddle_step = m_size / length;
+        for (size_t start = 0; start < m_size; start += length) {
+            for (size_t k = 0; k < half; k++) {
+                const std::complex<double> twiddle = inverse ?
+                    std::conj(m_twiddles[k * twiddle_step]) : m_twiddles[k * twiddle_step];
+                const std::complex<double> odd = data[start + k + half] * twiddle;
+                data[start + k + half] = data[start + k] - odd;
+                data[start + k] += odd;
+            }
+        }
+    }
+}
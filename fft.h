@@ -0,0 +1,24 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+// Iterative radix-2 complex FFT of a fixed power of two size.
+class Fft {
+public:
+    explicit Fft(size_t size);
+
+    size_t getSize() const;
+
+    // In place. The inverse transform is not scaled by 1 / size.
+    void transform(std::complex<double>* data, bool inverse) const;
+
+private:
+    size_t m_size;
+    std::vector<size_t> m_bit_reversed;
+    std::vector<std::complex<double>> m_twiddles; // exp(-2 pi i k / size) for k < size / 2
+};
+
+#endif // FFT_H
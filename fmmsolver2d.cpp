@@ -0,0 +1,483 @@
+#include <algorithm>
+#include <cmath>
+#include "fmmsolver2d.h"
+
+
+FmmSolver2D::FmmSolver2D(ThreadPool& thread_pool, float attraction, float radius, uint32_t order) :
+    m_thread_pool(thread_pool),
+    m_attraction(attraction),
+    m_radius(radius),
+    m_order(std::max(order, 1u))
+{
+    // terms sorted by degree, (a, b) means x^a y^b
+    m_term_index.assign((m_order + 1) * (m_order + 1), 0);
+    for (uint32_t degree = 0; degree <= m_order; degree++) {
+        for (uint32_t b = 0; b <= degree; b++) {
+            m_term_index[(degree - b) * (m_order + 1) + b] = static_cast<uint32_t>(m_term_a.size());
+            m_term_a.push_back(degree - b);
+            m_term_b.push_back(b);
+        }
+    }
+    m_num_terms = static_cast<uint32_t>(m_term_a.size());
+
+    m_factorials.resize(2 * m_order + 1);
+    m_factorials[0] = 1.0;
+    for (uint32_t i = 1; i < m_factorials.size(); i++) {
+        m_factorials[i] = m_factorials[i - 1] * static_cast<double>(i);
+    }
+}
+
+
+void FmmSolver2D::computeAccelerations(const std::vector<float>& pos_x, const std::vector<float>& pos_y,
+    const std::vector<float>& mass, std::vector<float>& acc_x, std::vector<float>& acc_y)
+{
+    acc_x.resize(pos_x.size());
+    acc_y.resize(pos_y.size());
+
+    if (pos_x.empty()) {
+        return;
+    }
+
+    sortPoints(pos_x, pos_y, mass);
+
+    pointsToMultipoles();
+    for (uint32_t level = m_num_levels - 1; level > 0; level--) {
+        multipolesToMultipoles(level);
+    }
+
+    // cells on levels 0 and 1 are all neighbours of each other, the far field starts at level 2
+    for (uint32_t level = MIN_LEVEL; level < m_num_levels; level++) {
+        if (level > MIN_LEVEL) {
+            localsToLocals(level);
+        } else {
+            std::fill(m_locals[level].begin(), m_locals[level].end(), 0.0);
+        }
+        multipolesToLocals(level);
+    }
+
+    localsToPoints(acc_x, acc_y);
+}
+
+
+uint32_t FmmSolver2D::termIndex(uint32_t a, uint32_t b) const
+{
+    return m_term_index[a * (m_order + 1) + b];
+}
+
+
+double FmmSolver2D::cellSize(uint32_t level) const
+{
+    return m_size / static_cast<double>(1u << level);
+}
+
+
+void FmmSolver2D::cellCenter(uint32_t level, uint32_t cell_x, uint32_t cell_y, double& center_x, double& center_y) const
+{
+    const double size = cellSize(level);
+    center_x = m_min_x + (static_cast<double>(cell_x) + 0.5) * size;
+    center_y = m_min_y + (static_cast<double>(cell_y) + 0.5) * size;
+}
+
+
+void FmmSolver2D::sortPoints(const std::vector<float>& pos_x, const std::vector<float>& pos_y, const std::vector<float>& mass)
+{
+    const uint32_t num_points = static_cast<uint32_t>(pos_x.size());
+
+    // leaves hold about LEAF_POINTS points on average
+    m_num_levels = MIN_LEVEL + 1;
+    while ((m_num_levels <= MAX_LEVEL) &&
+        ((static_cast<uint64_t>(1) << (2 * (m_num_levels - 1))) * LEAF_POINTS < num_points)) {
+        m_num_levels++;
+    }
+
+    auto [min_x, max_x] = std::minmax_element(pos_x.begin(), pos_x.end());
+    auto [min_y, max_y] = std::minmax_element(pos_y.begin(), pos_y.end());
+    m_min_x = *min_x;
+    m_min_y = *min_y;
+    // grow the square slightly so that the points on the upper edges fall inside the last cells
+    m_size = std::max(std::max(*max_x - *min_x, *max_y - *min_y), 1.0f) * (1.0 + 1e-6);
+
+    const uint32_t leaf_level = m_num_levels - 1;
+    const uint32_t leaf_side = 1u << leaf_level;
+    const double leaf_size = cellSize(leaf_level);
+
+    // counting sort of the points by leaf cell
+    std::vector<uint32_t> point_cells(num_points);
+    m_leaf_begin.assign(leaf_side * leaf_side + 1, 0);
+    for (uint32_t i = 0; i < num_points; i++) {
+        const uint32_t cell_x = std::min(static_cast<uint32_t>((pos_x[i] - m_min_x) / leaf_size), leaf_side - 1);
+        const uint32_t cell_y = std::min(static_cast<uint32_t>((pos_y[i] - m_min_y) / leaf_size), leaf_side - 1);
+        point_cells[i] = cell_y * leaf_side + cell_x;
+        m_leaf_begin[point_cells[i] + 1]++;
+    }
+    for (uint32_t cell = 0; cell < leaf_side * leaf_side; cell++) {
+        m_leaf_begin[cell + 1] += m_leaf_begin[cell];
+    }
+
+    std::vector<uint32_t> next(m_leaf_begin.begin(), m_leaf_begin.end() - 1);
+    m_indices.resize(num_points);
+    for (uint32_t i = 0; i < num_points; i++) {
+        m_indices[next[point_cells[i]]++] = i;
+    }
+
+    m_sorted_x.resize(num_points);
+    m_sorted_y.resize(num_points);
+    m_sorted_mass.resize(num_points);
+    for (uint32_t i = 0; i < num_points; i++) {
+        m_sorted_x[i] = pos_x[m_indices[i]];
+        m_sorted_y[i] = pos_y[m_indices[i]];
+        m_sorted_mass[i] = mass[m_indices[i]];
+    }
+
+    // number of points per cell on every level, used to skip empty cells
+    m_counts.resize(m_num_levels);
+    m_multipoles.resize(m_num_levels);
+    m_locals.resize(m_num_levels);
+    for (uint32_t level = 0; level < m_num_levels; level++) {
+        const uint32_t num_cells = 1u << (2 * level);
+        m_counts[level].assign(num_cells, 0);
+        m_multipoles[level].resize(num_cells * m_num_terms);
+        m_locals[level].resize(num_cells * m_num_terms);
+    }
+    for (uint32_t cell = 0; cell < leaf_side * leaf_side; cell++) {
+        m_counts[leaf_level][cell] = m_leaf_begin[cell + 1] - m_leaf_begin[cell];
+    }
+    for (uint32_t level = leaf_level; level > 0; level--) {
+        const uint32_t side = 1u << level;
+        for (uint32_t cell_y = 0; cell_y < side; cell_y++) {
+            for (uint32_t cell_x = 0; cell_x < side; cell_x++) {
+                m_counts[level - 1][(cell_y / 2) * (side / 2) + cell_x / 2] += m_counts[level][cell_y * side + cell_x];
+            }
+        }
+    }
+}
+
+
+void FmmSolver2D::pointsToMultipoles()
+{
+    const uint32_t leaf_level = m_num_levels - 1;
+    const uint32_t leaf_side = 1u << leaf_level;
+
+    m_thread_pool.parallelFor(leaf_side * leaf_side, [this, leaf_level, leaf_side](size_t begin, size_t end) {
+        std::vector<double> powers_x(m_order + 1);
+        std::vector<double> powers_y(m_order + 1);
+
+        for (size_t cell = begin; cell < end; cell++) {
+            double* multipole = &m_multipoles[leaf_level][cell * m_num_terms];
+            std::fill(multipole, multipole + m_num_terms, 0.0);
+
+            double center_x, center_y;
+            cellCenter(leaf_level, static_cast<uint32_t>(cell % leaf_side), static_cast<uint32_t>(cell / leaf_side),
+                center_x, center_y);
+
+            // M(a, b) = sum of m dx^a dy^b / (a! b!)
+            for (uint32_t i = m_leaf_begin[cell]; i < m_leaf_begin[cell + 1]; i++) {
+                const double dx = m_sorted_x[i] - center_x;
+                const double dy = m_sorted_y[i] - center_y;
+                powers_x[0] = 1.0;
+                powers_y[0] = 1.0;
+                for (uint32_t k = 1; k <= m_order; k++) {
+                    powers_x[k] = powers_x[k - 1] * dx / static_cast<double>(k);
+                    powers_y[k] = powers_y[k - 1] * dy / static_cast<double>(k);
+                }
+
+                const double mass = m_sorted_mass[i];
+                for (uint32_t term = 0; term < m_num_terms; term++) {
+                    multipole[term] += mass * powers_x[m_term_a[term]] * powers_y[m_term_b[term]];
+                }
+            }
+        }
+    });
+}
+
+
+void FmmSolver2D::multipolesToMultipoles(uint32_t level)
+{
+    // shifts the multipoles of the cells on this level to their parents
+    const uint32_t parent_side = 1u << (level - 1);
+    const double offset = cellSize(level) / 2.0;
+
+    m_thread_pool.parallelFor(parent_side * parent_side, [this, level, parent_side, offset](size_t begin, size_t end) {
+        std::vector<double> powers_x(m_order + 1);
+        std::vector<double> powers_y(m_order + 1);
+
+        for (size_t parent = begin; parent < end; parent++) {
+            double* parent_multipole = &m_multipoles[level - 1][parent * m_num_terms];
+            std::fill(parent_multipole, parent_multipole + m_num_terms, 0.0);
+
+            const uint32_t parent_x = static_cast<uint32_t>(parent % parent_side);
+            const uint32_t parent_y = static_cast<uint32_t>(parent / parent_side);
+
+            for (uint32_t child = 0; child < 4; child++) {
+                const uint32_t child_x = parent_x * 2 + (child & 1);
+                const uint32_t child_y = parent_y * 2 + (child >> 1);
+                const uint32_t child_cell = child_y * parent_side * 2 + child_x;
+                if (m_counts[level][child_cell] == 0) {
+                    continue;
+                }
+
+                const double* multipole = &m_multipoles[level][child_cell * m_num_terms];
+                const double dx = (child & 1) ? offset : -offset;
+                const double dy = (child >> 1) ? offset : -offset;
+                powers_x[0] = 1.0;
+                powers_y[0] = 1.0;
+                for (uint32_t k = 1; k <= m_order; k++) {
+                    powers_x[k] = powers_x[k - 1] * dx / static_cast<double>(k);
+                    powers_y[k] = powers_y[k - 1] * dy / static_cast<double>(k);
+                }
+
+                // M'(a, b) = sum over (i, j) <= (a, b) of M(i, j) dx^(a-i) dy^(b-j) / ((a-i)! (b-j)!)
+                for (uint32_t term = 0; term < m_num_terms; term++) {
+                    const uint32_t a = m_term_a[term];
+                    const uint32_t b = m_term_b[term];
+                    double sum = 0.0;
+                    for (uint32_t i = 0; i <= a; i++) {
+                        for (uint32_t j = 0; j <= b; j++) {
+                            sum += multipole[termIndex(i, j)] * powers_x[a - i] * powers_y[b - j];
+                        }
+                    }
+                    parent_multipole[term] += sum;
+                }
+            }
+        }
+    });
+}
+
+
+void FmmSolver2D::multipolesToLocals(uint32_t level)
+{
+    const uint32_t side = 1u << level;
+    const uint32_t stride = 2 * m_order + 1;
+    const double size = cellSize(level);
+
+    // source cells sit at most 3 cells away from the target, so there are only 7 x 7 different translations
+    std::vector<std::vector<double>> translations(7 * 7);
+    for (int offset_y = -3; offset_y <= 3; offset_y++) {
+        for (int offset_x = -3; offset_x <= 3; offset_x++) {
+            if ((std::abs(offset_x) > 1) || (std::abs(offset_y) > 1)) {
+                derivatives(offset_x * size, offset_y * size, translations[(offset_y + 3) * 7 + offset_x + 3]);
+            }
+        }
+    }
+
+    m_thread_pool.parallelFor(side * side, [this, level, side, stride, &translations](size_t begin, size_t end) {
+        std::vector<double> sums(m_num_terms);
+
+        for (size_t cell = begin; cell < end; cell++) {
+            if (m_counts[level][cell] == 0) {
+                continue;
+            }
+
+            const int cell_x = static_cast<int>(cell % side);
+            const int cell_y = static_cast<int>(cell / side);
+            std::fill(sums.begin(), sums.end(), 0.0);
+
+            // interaction list: children of the parent's neighbours that are not neighbours themselves
+            const int first_x = std::max((cell_x / 2 - 1) * 2, 0);
+            const int first_y = std::max((cell_y / 2 - 1) * 2, 0);
+            const int last_x = std::min((cell_x / 2 + 1) * 2 + 1, static_cast<int>(side) - 1);
+            const int last_y = std::min((cell_y / 2 + 1) * 2 + 1, static_cast<int>(side) - 1);
+
+            for (int source_y = first_y; source_y <= last_y; source_y++) {
+                for (int source_x = first_x; source_x <= last_x; source_x++) {
+                    if ((std::abs(source_x - cell_x) <= 1) && (std::abs(source_y - cell_y) <= 1)) {
+                        continue;
+                    }
+
+                    const uint32_t source = static_cast<uint32_t>(source_y) * side + static_cast<uint32_t>(source_x);
+                    if (m_counts[level][source] == 0) {
+                        continue;
+                    }
+
+                    const double* multipole = &m_multipoles[level][source * m_num_terms];
+                    const std::vector<double>& derivative =
+                        translations[(cell_y - source_y + 3) * 7 + (cell_x - source_x + 3)];
+
+                    for (uint32_t target_term = 0; target_term < m_num_terms; target_term++) {
+                        const uint32_t a = m_term_a[target_term];
+                        const uint32_t b = m_term_b[target_term];
+                        double sum = 0.0;
+                        for (uint32_t source_term = 0; source_term < m_num_terms; source_term++) {
+                            sum += multipole[source_term] *
+                                derivative[(a + m_term_a[source_term]) * stride + b + m_term_b[source_term]];
+                        }
+                        sums[target_term] += sum;
+                    }
+                }
+            }
+
+            // L(a, b) = (-1)^(a+b) / (a! b!) * sum of M(i, j) D^(a+i, b+j)
+            double* local = &m_locals[level][cell * m_num_terms];
+            for (uint32_t term = 0; term < m_num_terms; term++) {
+                const uint32_t a = m_term_a[term];
+                const uint32_t b = m_term_b[term];
+                const double sign = ((a + b) % 2 == 0) ? 1.0 : -1.0;
+                local[term] += sign * sums[term] / (m_factorials[a] * m_factorials[b]);
+            }
+        }
+    });
+}
+
+
+void FmmSolver2D::localsToLocals(uint32_t level)
+{
+    // shifts the locals of the parents on the previous level to the cells on this level
+    const uint32_t side = 1u << level;
+    const double offset = cellSize(level) / 2.0;
+
+    m_thread_pool.parallelFor(side * side, [this, level, side, offset](size_t begin, size_t end) {
+        std::vector<double> powers_x(m_order + 1);
+        std::vector<double> powers_y(m_order + 1);
+
+        for (size_t cell = begin; cell < end; cell++) {
+            double* local = &m_locals[level][cell * m_num_terms];
+            if (m_counts[level][cell] == 0) {
+                std::fill(local, local + m_num_terms, 0.0);
+                continue;
+            }
+
+            const uint32_t cell_x = static_cast<uint32_t>(cell % side);
+            const uint32_t cell_y = static_cast<uint32_t>(cell / side);
+            const double* parent_local = &m_locals[level - 1][((cell_y / 2) * (side / 2) + cell_x / 2) * m_num_terms];
+
+            const double dx = (cell_x & 1) ? offset : -offset;
+            const double dy = (cell_y & 1) ? offset : -offset;
+            powers_x[0] = 1.0;
+            powers_y[0] = 1.0;
+            for (uint32_t k = 1; k <= m_order; k++) {
+                powers_x[k] = powers_x[k - 1] * dx;
+                powers_y[k] = powers_y[k - 1] * dy;
+            }
+
+            // L'(a, b) = sum over (i, j) >= (a, b) of L(i, j) C(i, a) C(j, b) dx^(i-a) dy^(j-b)
+            for (uint32_t term = 0; term < m_num_terms; term++) {
+                const uint32_t a = m_term_a[term];
+                const uint32_t b = m_term_b[term];
+                double sum = 0.0;
+                for (uint32_t i = a; i <= m_order - b; i++) {
+                    for (uint32_t j = b; j <= m_order - i; j++) {
+                        const double binomials = m_factorials[i] / (m_factorials[a] * m_factorials[i - a]) *
+                            m_factorials[j] / (m_factorials[b] * m_factorials[j - b]);
+                        sum += parent_local[termIndex(i, j)] * binomials * powers_x[i - a] * powers_y[j - b];
+                    }
+                }
+                local[term] = sum;
+            }
+        }
+    });
+}
+
+
+void FmmSolver2D::localsToPoints(std::vector<float>& acc_x, std::vector<float>& acc_y)
+{
+    const uint32_t leaf_level = m_num_levels - 1;
+    const int leaf_side = 1 << leaf_level;
+    const double rad_2 = static_cast<double>(m_radius) * static_cast<double>(m_radius);
+
+    m_thread_pool.parallelFor(leaf_side * leaf_side, [&](size_t begin, size_t end) {
+        std::vector<double> powers_x(m_order + 1);
+        std::vector<double> powers_y(m_order + 1);
+
+        for (size_t cell = begin; cell < end; cell++) {
+            if (m_leaf_begin[cell] == m_leaf_begin[cell + 1]) {
+                continue;
+            }
+
+            const int cell_x = static_cast<int>(cell % leaf_side);
+            const int cell_y = static_cast<int>(cell / leaf_side);
+            const double* local = &m_locals[leaf_level][cell * m_num_terms];
+            double center_x, center_y;
+            cellCenter(leaf_level, static_cast<uint32_t>(cell_x), static_cast<uint32_t>(cell_y), center_x, center_y);
+
+            for (uint32_t i = m_leaf_begin[cell]; i < m_leaf_begin[cell + 1]; i++) {
+                const double pos_x = m_sorted_x[i];
+                const double pos_y = m_sorted_y[i];
+
+                // far field: gradient of the local expansion
+                const double dx = pos_x - center_x;
+                const double dy = pos_y - center_y;
+                powers_x[0] = 1.0;
+                powers_y[0] = 1.0;
+                for (uint32_t k = 1; k <= m_order; k++) {
+                    powers_x[k] = powers_x[k - 1] * dx;
+                    powers_y[k] = powers_y[k - 1] * dy;
+                }
+
+                double sum_x = 0.0;
+                double sum_y = 0.0;
+                for (uint32_t term = 1; term < m_num_terms; term++) {
+                    const uint32_t a = m_term_a[term];
+                    const uint32_t b = m_term_b[term];
+                    if (a > 0) {
+                        sum_x += local[term] * static_cast<double>(a) * powers_x[a - 1] * powers_y[b];
+                    }
+                    if (b > 0) {
+                        sum_y += local[term] * static_cast<double>(b) * powers_x[a] * powers_y[b - 1];
+                    }
+                }
+
+                // near field: all points in this and the neighbouring leaves
+                for (int neighbour_y = std::max(cell_y - 1, 0); neighbour_y <= std::min(cell_y + 1, leaf_side - 1); neighbour_y++) {
+                    for (int neighbour_x = std::max(cell_x - 1, 0); neighbour_x <= std::min(cell_x + 1, leaf_side - 1); neighbour_x++) {
+                        const uint32_t neighbour = static_cast<uint32_t>(neighbour_y * leaf_side + neighbour_x);
+                        for (uint32_t j = m_leaf_begin[neighbour]; j < m_leaf_begin[neighbour + 1]; j++) {
+                            const double rx = m_sorted_x[j] - pos_x;
+                            const double ry = m_sorted_y[j] - pos_y;
+                            const double dist_2 = rx * rx + ry * ry;
+                            if (dist_2 > rad_2) {
+                                const double inv_dist = 1.0 / std::sqrt(dist_2);
+                                const double factor = m_sorted_mass[j] * inv_dist * inv_dist * inv_dist;
+                                sum_x += rx * factor;
+                                sum_y += ry * factor;
+                            }
+                        }
+                    }
+                }
+
+                acc_x[m_indices[i]] = static_cast<float>(m_attraction * sum_x);
+                acc_y[m_indices[i]] = static_cast<float>(m_attraction * sum_y);
+            }
+        }
+    });
+}
+
+
+void FmmSolver2D::derivatives(double dx, double dy, std::vector<double>& coefficients) const
+{
+    // Taylor coefficients T(a, b) = (-1)^(a+b) / (a! b!) * d^(a+b)/(dx^a dy^b) 1/r from the recurrence
+    // r^2 T(k) = (2 - 1/|k|) (dx T(k - ex) + dy T(k - ey)) - (1 - 1/|k|) (T(k - 2ex) + T(k - 2ey)),
+    // stored multiplied by a! b! so that the translation only needs a single product per term
+    const uint32_t max_degree = 2 * m_order;
+    const uint32_t stride = max_degree + 1;
+    const double dist_2 = dx * dx + dy * dy;
+
+    coefficients.assign(stride * stride, 0.0);
+    coefficients[0] = 1.0 / std::sqrt(dist_2);
+    for (uint32_t degree = 1; degree <= max_degree; degree++) {
+        const double factor_1 = 2.0 - 1.0 / static_cast<double>(degree);
+        const double factor_2 = 1.0 - 1.0 / static_cast<double>(degree);
+        for (uint32_t a = 0; a <= degree; a++) {
+            const uint32_t b = degree - a;
+            double value = 0.0;
+            if (a >= 1) {
+                value += factor_1 * dx * coefficients[(a - 1) * stride + b];
+            }
+            if (b >= 1) {
+                value += factor_1 * dy * coefficients[a * stride + b - 1];
+            }
+            if (a >= 2) {
+                value -= factor_2 * coefficients[(a - 2) * stride + b];
+            }
+            if (b >= 2) {
+                value -= factor_2 * coefficients[a * stride + b - 2];
+            }
+            coefficients[a * stride + b] = value / dist_2;
+        }
+    }
+
+    for (uint32_t a = 0; a <= max_degree; a++) {
+        for (uint32_t b = 0; a + b <= max_degree; b++) {
+            coefficients[a * stride + b] *= m_factorials[a] * m_factorials[b];
+        }
+    }
+}
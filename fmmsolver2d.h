@@ -0,0 +1,59 @@
+#ifndef FMMSOLVER2D_H
+#define FMMSOLVER2D_H
+
+#include <cstdint>
+#include "forcesolver2d.h"
+
+// Fast multipole method on a uniform quadtree, best suited to evenly spread points.
+// The simulation uses the 1/r potential of 3D gravity restricted to the plane, which is not
+// harmonic in 2D, so the expansions are Cartesian Taylor series of 1/r rather than complex
+// logarithmic series. Expansion order p keeps the terms x^a y^b with a + b <= p.
+class FmmSolver2D : public ForceSolver2D {
+public:
+    FmmSolver2D(ThreadPool& thread_pool, float attraction, float radius, uint32_t order);
+
+    void computeAccelerations(const std::vector<float>& pos_x, const std::vector<float>& pos_y,
+        const std::vector<float>& mass, std::vector<float>& acc_x, std::vector<float>& acc_y) override;
+
+private:
+    static constexpr uint32_t MIN_LEVEL = 2;
+    static constexpr uint32_t MAX_LEVEL = 10;
+    static constexpr uint32_t LEAF_POINTS = 32; // average number of points per leaf
+
+    ThreadPool& m_thread_pool;
+    float m_attraction;
+    float m_radius;
+    uint32_t m_order;
+    uint32_t m_num_terms;
+    std::vector<uint32_t> m_term_a; // term -> exponent of x
+    std::vector<uint32_t> m_term_b; // term -> exponent of y
+    std::vector<uint32_t> m_term_index; // (a, b) -> term, indexed a * (order + 1) + b
+    std::vector<double> m_factorials;
+
+    uint32_t m_num_levels = 0;
+    double m_min_x = 0.0;
+    double m_min_y = 0.0;
+    double m_size = 0.0;
+    std::vector<uint32_t> m_leaf_begin; // leaf cell -> first point in leaf order, one extra entry at the end
+    std::vector<uint32_t> m_indices; // leaf order -> point index
+    std::vector<double> m_sorted_x;
+    std::vector<double> m_sorted_y;
+    std::vector<double> m_sorted_mass;
+    std::vector<std::vector<uint32_t>> m_counts; // [level][cell] number of points
+    std::vector<std::vector<double>> m_multipoles; // [level][cell * num_terms + term]
+    std::vector<std::vector<double>> m_locals; // [level][cell * num_terms + term]
+
+    uint32_t termIndex(uint32_t a, uint32_t b) const;
+    double cellSize(uint32_t level) const;
+    void cellCenter(uint32_t level, uint32_t cell_x, uint32_t cell_y, double& center_x, double& center_y) const;
+
+    void sortPoints(const std::vector<float>& pos_x, const std::vector<float>& pos_y, const std::vector<float>& mass);
+    void pointsToMultipoles();
+    void multipolesToMultipoles(uint32_t level);
+    void multipolesToLocals(uint32_t level);
+    void localsToLocals(uint32_t level);
+    void localsToPoints(std::vector<float>& acc_x, std::vector<float>& acc_y);
+    void derivatives(double dx, double dy, std::vector<double>& coefficients) const;
+};
+
+#endif // FMMSOLVER2D_H
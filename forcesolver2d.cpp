@@ -0,0 +1,28 @@
+#include "forcesolver2d.h"
+#include "barneshutsolver2d.h"
+#include "fmmsolver2d.h"
+#include "p3msolver2d.h"
+#include "pmsolver2d.h"
+#include "symmetricsolver2d.h"
+
+
+std::unique_ptr<ForceSolver2D> ForceSolver2D::create(const ForceSolverSettings2D& settings, ThreadPool& thread_pool,
+    float attraction, float radius)
+{
+    switch (settings.method) {
+    case ForceSolverSettings2D::Method::BarnesHut:
+        return std::make_unique<BarnesHutSolver2D>(thread_pool, attraction, radius, settings.barnes_hut_theta);
+    case ForceSolverSettings2D::Method::Fmm:
+        return std::make_unique<FmmSolver2D>(thread_pool, attraction, radius, settings.fmm_order);
+    case ForceSolverSettings2D::Method::ParticleMesh:
+        return std::make_unique<PmSolver2D>(thread_pool, attraction, radius, settings.pm_grid_size,
+            settings.pm_mass_assignment);
+    case ForceSolverSettings2D::Method::P3m:
+        return std::make_unique<P3mSolver2D>(thread_pool, attraction, radius, settings.pm_grid_size,
+            settings.pm_mass_assignment, settings.p3m_split_radius);
+    case ForceSolverSettings2D::Method::Symmetric:
+        return std::make_unique<SymmetricSolver2D>(thread_pool, attraction, radius);
+    default:
+        return nullptr;
+    }
+}
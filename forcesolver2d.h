@@ -0,0 +1,47 @@
+#ifndef FORCESOLVER2D_H
+#define FORCESOLVER2D_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "threadpool.h"
+
+struct ForceSolverSettings2D {
+    enum class Method {
+        Direct,
+        BarnesHut,
+        RadixTree, // Barnes-Hut on a radix tree built on the OpenCL device, OpenCL backend only
+        Fmm, // fast multipole method
+        ParticleMesh, // grid based, resolves the large scale field only
+        P3m, // particle-mesh for the long range plus direct sums for the short range
+        Symmetric // direct sum over unordered pairs, each pair evaluated once
+    };
+
+    enum class MassAssignment {
+        Cic, // cloud in cell, 2 x 2 grid nodes per point
+        Tsc // triangular shaped cloud, 3 x 3 grid nodes per point
+    };
+
+    Method method = Method::Direct;
+    float barnes_hut_theta = 0.5f; // opening angle, 0 opens every node (also used by RadixTree)
+    uint32_t fmm_order = 6; // highest degree of the multipole and local expansions
+    uint32_t pm_grid_size = 256; // grid nodes per side, rounded up to a power of two
+    MassAssignment pm_mass_assignment = MassAssignment::Tsc; // also used by P3m
+    float p3m_split_radius = 2.0f; // in grid cells, P3m uses pm_grid_size as well
+};
+
+// Host side replacement for the all-pairs "accelerations" kernel. The attraction is per unit mass, every point
+// pulls with its own mass.
+class ForceSolver2D {
+public:
+    // Returns nullptr for the methods the backends implement themselves.
+    static std::unique_ptr<ForceSolver2D> create(const ForceSolverSettings2D& settings, ThreadPool& thread_pool,
+        float attraction, float radius);
+
+    virtual ~ForceSolver2D() = default;
+
+    virtual void computeAccelerations(const std::vector<float>& pos_x, const std::vector<float>& pos_y,
+        const std::vector<float>& mass, std::vector<float>& acc_x, std::vector<float>& acc_y) = 0;
+};
+
+#endif // FORCESOLVER2D_H
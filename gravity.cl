@@ -1,15 +1,137 @@
-kernel void accelerations(global float2* pos, global float2* acc, const float attr, const float rad) {
+// The points are (x, y, mass, unused), so one load fetches both the position and the mass of a point.
+kernel void accelerations(global float4* pos, global VECTOR_STORAGE* acc, const float attr_arg, const float rad_arg) {
     unsigned long n = get_global_size(0);
     unsigned long i = get_global_id(0);
+    const float attr = ATTRACTION(attr_arg);
+    const float rad = RADIUS(rad_arg);
+    const float inv_rad = 1.0f / rad;
+    const float inv_rad_3 = inv_rad * inv_rad * inv_rad;
+    const float2 pos_i = pos[i].xy;
+    SUM_DECLARE(acc_i);
 
-    acc[i] = (float2)(0.0f, 0.0f);
-
+    UNROLL_LOOP
     for (unsigned long j = 0; j < n; j++) {
         if (i != j) {
-            float dist = distance(pos[j], pos[i]);
-            if (dist > rad) {
-                acc[i] += (attr / dist / dist / dist) * (pos[j] - pos[i]);
+            float4 body_j = pos[j];
+            float2 delta = body_j.xy - pos_i;
+            SUM_ADD(acc_i, (attr * body_j.z * force_factor(dot(delta, delta), rad, inv_rad, inv_rad_3)) * delta);
+        }
+    }
+
+    STORE_VECTOR(SUM_RESULT(acc_i), acc, i, ACC_UNIT);
+}
+
+// Same as "accelerations", but each work-group loads the positions in tiles of its own size into local memory.
+// The global size is padded to a multiple of the work-group size, n is the number of points.
+kernel void accelerations_tiled(global float4* pos, global VECTOR_STORAGE* acc, const float attr_arg, const float rad_arg, const uint n_arg, local float4* tile) {
+    uint i = get_global_id(0);
+    uint lid = get_local_id(0);
+    const uint tile_size = TILE_SIZE;
+    const uint n = NUM_POINTS(n_arg);
+    const float attr = ATTRACTION(attr_arg);
+    const float rad = RADIUS(rad_arg);
+    const float inv_rad = 1.0f / rad;
+    const float inv_rad_3 = inv_rad * inv_rad * inv_rad;
+
+    float2 pos_i = pos[min(i, n - 1)].xy;
+    SUM_DECLARE(acc_i);
+
+    for (uint tile_start = 0; tile_start < n; tile_start += tile_size) {
+        tile[lid] = pos[min(tile_start + lid, n - 1)];
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        uint tile_count = min(tile_size, n - tile_start);
+        UNROLL_LOOP
+        for (uint k = 0; k < tile_count; k++) {
+            if (tile_start + k != i) {
+                float4 body_k = tile[k];
+                float2 delta = body_k.xy - pos_i;
+                SUM_ADD(acc_i, (attr * body_k.z * force_factor(dot(delta, delta), rad, inv_rad, inv_rad_3)) * delta);
+            }
+        }
+
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    if (i < n) {
+        STORE_VECTOR(SUM_RESULT(acc_i), acc, i, ACC_UNIT);
+    }
+}
+
+// Each unordered pair once, launched in bands of diagonals of the tile pairs. A launch takes the pairs (a, a + offset)
+// for band_size offsets from first_offset, work-group a loops over them and the pairs beyond the last tile are left
+// out. At step k work-item l pairs with column (l + k) % tile_size, so no two work-items touch the same column within
+// a step. What tile a + offset gets back goes to slot offset - first_offset of the band, what tile a gets from the
+// whole band to slot band_size, so every value has a single writer: band[slot * num_tiles * tile_size + i] for point i.
+// "accelerations_reduce" adds the slots to the sums in a fixed order. Both halves are summed with the selected
+// precision.
+kernel void accelerations_symmetric(global float4* pos, global SUM_STORAGE* band, const float attr_arg, const float rad_arg,
+    const uint n_arg, const uint num_tiles, const uint first_offset, const uint band_size, local float4* tile_pos,
+    local SUM_STORAGE* tile_acc) {
+    const uint tile_a = get_group_id(0);
+    const uint lid = get_local_id(0);
+    const uint tile_size = get_local_size(0);
+    const uint slot_size = num_tiles * tile_size;
+    const uint n = NUM_POINTS(n_arg);
+    const float attr = ATTRACTION(attr_arg);
+    const float rad = RADIUS(rad_arg);
+    const float inv_rad = 1.0f / rad;
+    const float inv_rad_3 = inv_rad * inv_rad * inv_rad;
+
+    const uint i = tile_a * tile_size + lid;
+    const float4 body_i = pos[min(i, n - 1)];
+    SUM_DECLARE(acc_i);
+
+    for (uint slot = 0; (slot < band_size) && (tile_a + first_offset + slot < num_tiles); slot++) {
+        const uint tile_b = tile_a + first_offset + slot;
+        tile_pos[lid] = pos[min(tile_b * tile_size + lid, n - 1)];
+        tile_acc[lid] = SUM_ZERO;
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        for (uint k = 0; k < tile_size; k++) {
+            const uint column = (lid + k) % tile_size;
+            const uint j = tile_b * tile_size + column;
+            const bool counted = (tile_a != tile_b) || (column > lid);
+            if (counted && (i < n) && (j < n)) {
+                float4 body_j = tile_pos[column];
+                float2 delta = body_j.xy - body_i.xy;
+                float2 force = (attr * force_factor(dot(delta, delta), rad, inv_rad, inv_rad_3)) * delta;
+                SUM_ADD(acc_i, body_j.z * force);
+                SUM_ADD(tile_acc[column], -body_i.z * force);
             }
+
+            barrier(CLK_LOCAL_MEM_FENCE);
         }
+
+        // every work-item reads back and resets only its own column, the barriers above order it after the updates
+        band[slot * slot_size + tile_b * tile_size + lid] = tile_acc[lid];
+    }
+
+    band[band_size * slot_size + i] = acc_i;
+}
+
+// Adds the slots of one band to the sums of the points, the last band stores the accelerations.
+kernel void accelerations_reduce(global SUM_STORAGE* band, global SUM_STORAGE* sums, global VECTOR_STORAGE* acc, const uint n_arg,
+    const uint num_tiles, const uint tile_size, const uint first_offset, const uint band_size, const uint last_band) {
+    const uint i = get_global_id(0);
+    if (i >= NUM_POINTS(n_arg)) {
+        return;
+    }
+
+    const uint tile = i / tile_size;
+    const uint slot_size = num_tiles * tile_size;
+    SUM_STORAGE sum = (first_offset > 0) ? sums[i] : SUM_ZERO;
+    for (uint slot = 0; (slot < band_size) && (first_offset + slot <= tile); slot++) {
+        SUM_MERGE(sum, band[slot * slot_size + i]);
+    }
+
+    if (tile + first_offset < num_tiles) {
+        SUM_MERGE(sum, band[band_size * slot_size + i]);
+    }
+
+    if (last_band) {
+        STORE_VECTOR(SUM_RESULT(sum), acc, i, ACC_UNIT);
+    } else {
+        sums[i] = sum;
     }
 }
@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "gravitykernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define GRAVITYKERNELS_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+
+GravityKernels::Isa GravityKernels::detectIsa()
+{
+#if defined(GRAVITYKERNELS_X86) && defined(_MSC_VER)
+    int cpu_info[4];
+    __cpuid(cpu_info, 0);
+    const int max_leaf = cpu_info[0];
+
+    __cpuid(cpu_info, 1);
+    const bool has_sse4 = (cpu_info[2] & (1 << 19)) != 0;
+    const bool has_fma = (cpu_info[2] & (1 << 12)) != 0;
+    const bool has_osxsave = (cpu_info[2] & (1 << 27)) != 0;
+
+    // the operating system has to save the AVX (and AVX-512) registers on context switches
+    const unsigned long long xcr0 = has_osxsave ? _xgetbv(0) : 0;
+    const bool os_avx = (xcr0 & 0x06) == 0x06;
+    const bool os_avx512 = (xcr0 & 0xE6) == 0xE6;
+
+    bool has_avx2 = false;
+    bool has_avx512 = false;
+    if (max_leaf >= 7) {
+        __cpuidex(cpu_info, 7, 0);
+        has_avx2 = (cpu_info[1] & (1 << 5)) != 0;
+        has_avx512 = (cpu_info[1] & (1 << 16)) != 0;
+    }
+
+    if (has_avx512 && os_avx512) {
+        return Isa::Avx512;
+    }
+
+    if (has_avx2 && has_fma && os_avx) {
+        return Isa::Avx2;
+    }
+
+    if (has_sse4) {
+        return Isa::Sse4;
+    }
+#elif defined(GRAVITYKERNELS_X86)
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f")) {
+        return Isa::Avx512;
+    }
+
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return Isa::Avx2;
+    }
+
+    if (__builtin_cpu_supports("sse4.1")) {
+        return Isa::Sse4;
+    }
+#endif
+
+    return Isa::Scalar;
+}
+
+GravityKernels::Function GravityKernels::getFunction(Isa isa)
+{
+    switch (isa) {
+    case Isa::Sse4:
+        return accelerationsSse4;
+    case Isa::Avx2:
+        return accelerationsAvx2;
+    case Isa::Avx512:
+        return accelerationsAvx512;
+    default:
+        return accelerationsScalar;
+    }
+}
+
+const char* GravityKernels::getIsaName(Isa isa)
+{
+    switch (isa) {
+    case Isa::Sse4:
+        return "SSE4";
+    case Isa::Avx2:
+        return "AVX2";
+    case Isa::Avx512:
+        return "AVX-512";
+    default:
+        return "scalar";
+    }
+}
+
+float GravityKernels::compareToScalar(Isa isa, const float* pos_x, const float* pos_y, const float* mass, size_t num_points, size_t num_samples,
+    float attraction, float radius)
+{
+    num_samples = std::min(num_samples, num_points);
+
+    std::vector<float> ref_acc_x(num_samples);
+    std::vector<float> ref_acc_y(num_samples);
+    accelerationsScalar(pos_x, pos_y, mass, num_points, 0, num_samples, attraction, radius, ref_acc_x.data(), ref_acc_y.data());
+
+    std::vector<float> acc_x(num_samples);
+    std::vector<float> acc_y(num_samples);
+    getFunction(isa)(pos_x, pos_y, mass, num_points, 0, num_samples, attraction, radius, acc_x.data(), acc_y.data());
+
+    float max_ref_acc = 0.0f;
+    float max_diff = 0.0f;
+    for (size_t i = 0; i < num_samples; i++) {
+        max_ref_acc = std::max(max_ref_acc, std::hypot(ref_acc_x[i], ref_acc_y[i]));
+        max_diff = std::max(max_diff, std::hypot(acc_x[i] - ref_acc_x[i], acc_y[i] - ref_acc_y[i]));
+    }
+
+    return max_ref_acc > 0.0f ? max_diff / max_ref_acc : max_diff;
+}
+
+void GravityKernels::accelerationsScalar(const float* pos_x, const float* pos_y, const float* mass, size_t num_points, size_t begin, size_t end,
+    float attraction, float radius, float* acc_x, float* acc_y)
+{
+    for (size_t i = begin; i < end; i++) {
+        float sum_x = 0.0f;
+        float sum_y = 0.0f;
+
+        for (size_t j = 0; j < num_points; j++) {
+            if (i != j) {
+                float dx = pos_x[j] - pos_x[i];
+                float dy = pos_y[j] - pos_y[i];
+                float dist = std::sqrt(dx * dx + dy * dy);
+                if (dist > radius) {
+                    float factor = attraction * mass[j] / dist / dist / dist;
+                    sum_x += factor * dx;
+                    sum_y += factor * dy;
+                }
+            }
+        }
+
+        acc_x[i] = sum_x;
+        acc_y[i] = sum_y;
+    }
+}
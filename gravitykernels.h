@@ -0,0 +1,39 @@
+#ifndef GRAVITYKERNELS_H
+#define GRAVITYKERNELS_H
+
+#include <cstddef>
+
+// Host implementations of the "accelerations" kernel over a structure-of-arrays layout.
+// Each one writes acc_x[i], acc_y[i] for the points i in [begin, end), attracted by all num_points points,
+// each with its own mass. The attraction is per unit mass.
+class GravityKernels {
+public:
+    enum class Isa {
+        Scalar,
+        Sse4,
+        Avx2,
+        Avx512
+    };
+
+    using Function = void (*)(const float* pos_x, const float* pos_y, const float* mass, size_t num_points, size_t begin, size_t end,
+        float attraction, float radius, float* acc_x, float* acc_y);
+
+    static Isa detectIsa();
+    static Function getFunction(Isa isa);
+    static const char* getIsaName(Isa isa);
+
+    // Largest acceleration difference to the scalar reference, relative to the largest reference acceleration.
+    static float compareToScalar(Isa isa, const float* pos_x, const float* pos_y, const float* mass, size_t num_points, size_t num_samples,
+        float attraction, float radius);
+
+    static void accelerationsScalar(const float* pos_x, const float* pos_y, const float* mass, size_t num_points, size_t begin, size_t end,
+        float attraction, float radius, float* acc_x, float* acc_y);
+    static void accelerationsSse4(const float* pos_x, const float* pos_y, const float* mass, size_t num_points, size_t begin, size_t end,
+        float attraction, float radius, float* acc_x, float* acc_y);
+    static void accelerationsAvx2(const float* pos_x, const float* pos_y, const float* mass, size_t num_points, size_t begin, size_t end,
+        float attraction, float radius, float* acc_x, float* acc_y);
+    static void accelerationsAvx512(const float* pos_x, const float* pos_y, const float* mass, size_t num_points, size_t begin, size_t end,
+        float attraction, float radius, float* acc_x, float* acc_y);
+};
+
+#endif // GRAVITYKERNELS_H
@@ -0,0 +1,77 @@
+#include <cmath>
+#include "gravitykernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+
+static inline float horizontalSum(__m256 value)
+{
+    __m128 low = _mm_add_ps(_mm256_castps256_ps128(value), _mm256_extractf128_ps(value, 1));
+    __m128 shuffled = _mm_movehdup_ps(low);
+    __m128 sums = _mm_add_ps(low, shuffled);
+    shuffled = _mm_movehl_ps(shuffled, sums);
+    sums = _mm_add_ss(sums, shuffled);
+    return _mm_cvtss_f32(sums);
+}
+
+void GravityKernels::accelerationsAvx2(const float* pos_x, const float* pos_y, const float* mass, size_t num_points, size_t begin, size_t end,
+    float attraction, float radius, float* acc_x, float* acc_y)
+{
+    const size_t num_vector_points = num_points - num_points % 8;
+    const __m256 attr = _mm256_set1_ps(attraction);
+    const __m256 rad_2 = _mm256_set1_ps(radius * radius);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 three_halves = _mm256_set1_ps(1.5f);
+
+    for (size_t i = begin; i < end; i++) {
+        const __m256 pos_x_i = _mm256_set1_ps(pos_x[i]);
+        const __m256 pos_y_i = _mm256_set1_ps(pos_y[i]);
+        __m256 sum_x = _mm256_setzero_ps();
+        __m256 sum_y = _mm256_setzero_ps();
+
+        for (size_t j = 0; j < num_vector_points; j += 8) {
+            __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(pos_x + j), pos_x_i);
+            __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(pos_y + j), pos_y_i);
+            __m256 dist_2 = _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dx, dx));
+
+            // fast reciprocal square root, refined by one Newton-Raphson iteration
+            __m256 inv_dist = _mm256_rsqrt_ps(dist_2);
+            inv_dist = _mm256_mul_ps(inv_dist, _mm256_fnmadd_ps(_mm256_mul_ps(half, dist_2), _mm256_mul_ps(inv_dist, inv_dist), three_halves));
+
+            // the cutoff mask also drops the point itself, whose factor is not finite
+            __m256 factor = _mm256_mul_ps(_mm256_mul_ps(attr, _mm256_loadu_ps(mass + j)), _mm256_mul_ps(_mm256_mul_ps(inv_dist, inv_dist), inv_dist));
+            factor = _mm256_and_ps(factor, _mm256_cmp_ps(dist_2, rad_2, _CMP_GT_OQ));
+
+            sum_x = _mm256_fmadd_ps(factor, dx, sum_x);
+            sum_y = _mm256_fmadd_ps(factor, dy, sum_y);
+        }
+
+        float tail_sum_x = 0.0f;
+        float tail_sum_y = 0.0f;
+        for (size_t j = num_vector_points; j < num_points; j++) {
+            if (i != j) {
+                float dx = pos_x[j] - pos_x[i];
+                float dy = pos_y[j] - pos_y[i];
+                float dist = std::sqrt(dx * dx + dy * dy);
+                if (dist > radius) {
+                    float factor = attraction * mass[j] / dist / dist / dist;
+                    tail_sum_x += factor * dx;
+                    tail_sum_y += factor * dy;
+                }
+            }
+        }
+
+        acc_x[i] = horizontalSum(sum_x) + tail_sum_x;
+        acc_y[i] = horizontalSum(sum_y) + tail_sum_y;
+    }
+}
+
+#else
+
+void GravityKernels::accelerationsAvx2(const float* pos_x, const float* pos_y, const float* mass, size_t num_points, size_t begin, size_t end,
+    float attraction, float radius, float* acc_x, float* acc_y)
+{
+    accelerationsScalar(pos_x, pos_y, mass, num_points, begin, end, attraction, radius, acc_x, acc_y);
+}
+
+#endif
@@ -0,0 +1,54 @@
+#include "gravitykernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+
+void GravityKernels::accelerationsAvx512(const float* pos_x, const float* pos_y, const float* mass, size_t num_points, size_t begin, size_t end,
+    float attraction, float radius, float* acc_x, float* acc_y)
+{
+    const __m512 attr = _mm512_set1_ps(attraction);
+    const __m512 rad_2 = _mm512_set1_ps(radius * radius);
+    const __m512 half = _mm512_set1_ps(0.5f);
+    const __m512 three_halves = _mm512_set1_ps(1.5f);
+
+    for (size_t i = begin; i < end; i++) {
+        const __m512 pos_x_i = _mm512_set1_ps(pos_x[i]);
+        const __m512 pos_y_i = _mm512_set1_ps(pos_y[i]);
+        __m512 sum_x = _mm512_setzero_ps();
+        __m512 sum_y = _mm512_setzero_ps();
+
+        for (size_t j = 0; j < num_points; j += 16) {
+            // the last iteration only loads the remaining points
+            const __mmask16 valid = (num_points - j >= 16) ? static_cast<__mmask16>(0xFFFF) : static_cast<__mmask16>((1u << (num_points - j)) - 1);
+
+            __m512 dx = _mm512_sub_ps(_mm512_maskz_loadu_ps(valid, pos_x + j), pos_x_i);
+            __m512 dy = _mm512_sub_ps(_mm512_maskz_loadu_ps(valid, pos_y + j), pos_y_i);
+            __m512 dist_2 = _mm512_fmadd_ps(dy, dy, _mm512_mul_ps(dx, dx));
+
+            // fast reciprocal square root, refined by one Newton-Raphson iteration
+            __m512 inv_dist = _mm512_rsqrt14_ps(dist_2);
+            inv_dist = _mm512_mul_ps(inv_dist, _mm512_fnmadd_ps(_mm512_mul_ps(half, dist_2), _mm512_mul_ps(inv_dist, inv_dist), three_halves));
+
+            // the cutoff mask also drops the point itself, whose factor is not finite
+            __mmask16 attracting = _mm512_mask_cmp_ps_mask(valid, dist_2, rad_2, _CMP_GT_OQ);
+            __m512 factor = _mm512_maskz_mul_ps(attracting, _mm512_mul_ps(attr, _mm512_maskz_loadu_ps(valid, mass + j)),
+                _mm512_mul_ps(_mm512_mul_ps(inv_dist, inv_dist), inv_dist));
+
+            sum_x = _mm512_fmadd_ps(factor, dx, sum_x);
+            sum_y = _mm512_fmadd_ps(factor, dy, sum_y);
+        }
+
+        acc_x[i] = _mm512_reduce_add_ps(sum_x);
+        acc_y[i] = _mm512_reduce_add_ps(sum_y);
+    }
+}
+
+#else
+
+void GravityKernels::accelerationsAvx512(const float* pos_x, const float* pos_y, const float* mass, size_t num_points, size_t begin, size_t end,
+    float attraction, float radius, float* acc_x, float* acc_y)
+{
+    accelerationsScalar(pos_x, pos_y, mass, num_points, begin, end, attraction, radius, acc_x, acc_y);
+}
+
+#endif
@@ -0,0 +1,76 @@
+#include <cmath>
+#include "gravitykernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <smmintrin.h>
+
+static inline float horizontalSum(__m128 value)
+{
+    __m128 shuffled = _mm_movehdup_ps(value);
+    __m128 sums = _mm_add_ps(value, shuffled);
+    shuffled = _mm_movehl_ps(shuffled, sums);
+    sums = _mm_add_ss(sums, shuffled);
+    return _mm_cvtss_f32(sums);
+}
+
+void GravityKernels::accelerationsSse4(const float* pos_x, const float* pos_y, const float* mass, size_t num_points, size_t begin, size_t end,
+    float attraction, float radius, float* acc_x, float* acc_y)
+{
+    const size_t num_vector_points = num_points - num_points % 4;
+    const __m128 attr = _mm_set1_ps(attraction);
+    const __m128 rad_2 = _mm_set1_ps(radius * radius);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 three_halves = _mm_set1_ps(1.5f);
+
+    for (size_t i = begin; i < end; i++) {
+        const __m128 pos_x_i = _mm_set1_ps(pos_x[i]);
+        const __m128 pos_y_i = _mm_set1_ps(pos_y[i]);
+        __m128 sum_x = _mm_setzero_ps();
+        __m128 sum_y = _mm_setzero_ps();
+
+        for (size_t j = 0; j < num_vector_points; j += 4) {
+            __m128 dx = _mm_sub_ps(_mm_loadu_ps(pos_x + j), pos_x_i);
+            __m128 dy = _mm_sub_ps(_mm_loadu_ps(pos_y + j), pos_y_i);
+            __m128 dist_2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+
+            // fast reciprocal square root, refined by one Newton-Raphson iteration
+            __m128 inv_dist = _mm_rsqrt_ps(dist_2);
+            inv_dist = _mm_mul_ps(inv_dist, _mm_sub_ps(three_halves, _mm_mul_ps(_mm_mul_ps(half, dist_2), _mm_mul_ps(inv_dist, inv_dist))));
+
+            // the cutoff mask also drops the point itself, whose factor is not finite
+            __m128 factor = _mm_mul_ps(_mm_mul_ps(attr, _mm_loadu_ps(mass + j)), _mm_mul_ps(_mm_mul_ps(inv_dist, inv_dist), inv_dist));
+            factor = _mm_and_ps(factor, _mm_cmpgt_ps(dist_2, rad_2));
+
+            sum_x = _mm_add_ps(sum_x, _mm_mul_ps(factor, dx));
+            sum_y = _mm_add_ps(sum_y, _mm_mul_ps(factor, dy));
+        }
+
+        float tail_sum_x = 0.0f;
+        float tail_sum_y = 0.0f;
+        for (size_t j = num_vector_points; j < num_points; j++) {
+            if (i != j) {
+                float dx = pos_x[j] - pos_x[i];
+                float dy = pos_y[j] - pos_y[i];
+                float dist = std::sqrt(dx * dx + dy * dy);
+                if (dist > radius) {
+                    float factor = attraction * mass[j] / dist / dist / dist;
+                    tail_sum_x += factor * dx;
+                    tail_sum_y += factor * dy;
+                }
+            }
+        }
+
+        acc_x[i] = horizontalSum(sum_x) + tail_sum_x;
+        acc_y[i] = horizontalSum(sum_y) + tail_sum_y;
+    }
+}
+
+#else
+
+void GravityKernels::accelerationsSse4(const float* pos_x, const float* pos_y, const float* mass, size_t num_points, size_t begin, size_t end,
+    float attraction, float radius, float* acc_x, float* acc_y)
+{
+    accelerationsScalar(pos_x, pos_y, mass, num_points, begin, end, attraction, radius, acc_x, acc_y);
+}
+
+#endif
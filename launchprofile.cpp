@@ -0,0 +1,63 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include "launchprofile.h"
+
+
+std::string LaunchProfile::filePath(const std::string& directory, const cl::Device& ocl_device)
+{
+    std::string file_name = ocl_device.getInfo<CL_DEVICE_NAME>() + "-" + ocl_device.getInfo<CL_DRIVER_VERSION>();
+    for (char& c : file_name) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && (c != '.') && (c != '-')) {
+            c = '_';
+        }
+    }
+
+    return (std::filesystem::path(directory) / (file_name + ".profile")).string();
+}
+
+bool LaunchProfile::load(const std::string& file_path)
+{
+    std::ifstream profile_file(file_path);
+    if (!profile_file) {
+        return false;
+    }
+
+    // "key=value" lines, unknown keys are skipped so that older builds read newer profiles
+    LaunchProfile profile;
+    std::string line;
+    while (std::getline(profile_file, line)) {
+        size_t separator = line.find('=');
+        if (separator == std::string::npos) {
+            continue;
+        }
+
+        const std::string key = line.substr(0, separator);
+        const size_t value = std::strtoul(line.c_str() + separator + 1, nullptr, 10);
+        if (key == "work_group_size") {
+            profile.work_group_size = value;
+        } else if (key == "unroll") {
+            profile.unroll = std::max<size_t>(value, 1);
+        } else if (key == "leapfrog_work_group_size") {
+            profile.leapfrog_work_group_size = value;
+        }
+    }
+
+    *this = profile;
+    return true;
+}
+
+bool LaunchProfile::save(const std::string& file_path) const
+{
+    std::error_code fs_err;
+    std::filesystem::create_directories(std::filesystem::path(file_path).parent_path(), fs_err);
+
+    std::ofstream profile_file(file_path, std::ios::trunc);
+    profile_file << "work_group_size=" << work_group_size << "\n"
+        << "unroll=" << unroll << "\n"
+        << "leapfrog_work_group_size=" << leapfrog_work_group_size << "\n";
+
+    return static_cast<bool>(profile_file);
+}
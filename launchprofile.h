@@ -0,0 +1,25 @@
+#ifndef LAUNCHPROFILE_H
+#define LAUNCHPROFILE_H
+
+#include <cstddef>
+#include <string>
+
+#define CL_HPP_MINIMUM_OPENCL_VERSION 110
+#define CL_HPP_TARGET_OPENCL_VERSION 110
+#include <CL/cl2.hpp>
+
+// Launch configuration of the simulation kernels found by the autotuner, stored as one small text file per
+// device so that later runs start with it.
+struct LaunchProfile {
+    size_t work_group_size = 256; // tile size of the direct kernel, 0 runs the untiled kernel
+    size_t unroll = 1; // unroll factor of the force loops
+    size_t leapfrog_work_group_size = 0; // 0 leaves the choice to the driver
+
+    // File of the device in directory, named after the device and its driver.
+    static std::string filePath(const std::string& directory, const cl::Device& ocl_device);
+
+    bool load(const std::string& file_path);
+    bool save(const std::string& file_path) const;
+};
+
+#endif // LAUNCHPROFILE_H
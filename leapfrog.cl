@@ -1,43 +1,61 @@
-kernel void positions(global float2* pos, global float2* vel, global float2* acc, const float dt, const float max_pos, const float max_vel) {
+kernel void positions(global float4* pos, global VECTOR_STORAGE* vel, global VECTOR_STORAGE* acc, const float dt_arg, const float max_pos_arg, const float max_vel_arg, const uint n_arg) {
     unsigned long i = get_global_id(0);
+    if (i >= NUM_POINTS(n_arg)) {
+        return;
+    }
+
+    const float dt = TIME_STEP(dt_arg);
+    const float max_pos = MAX_POS(max_pos_arg);
+    const float max_vel = MAX_VEL(max_vel_arg);
     const float dt_2 = dt / 2.0f;
 
-    vel[i] += dt_2 * acc[i];
+    float2 vel_i = LOAD_VECTOR(vel, i, VEL_UNIT) + dt_2 * LOAD_VECTOR(acc, i, ACC_UNIT);
 
-    if (length(vel[i]) > max_vel) {
-        vel[i] = max_vel * normalize(vel[i]);
+    if (length(vel_i) > max_vel) {
+        vel_i = max_vel * normalize(vel_i);
     }
 
-    pos[i] += dt * vel[i];
+    float2 pos_i = pos[i].xy + dt * vel_i;
 
-    if (pos[i].x > max_pos) {
-        pos[i].x = max_pos;
-        vel[i].x *= -1.0f;
+    if (pos_i.x > max_pos) {
+        pos_i.x = max_pos;
+        vel_i.x *= -1.0f;
     }
 
-    if (pos[i].x < -max_pos) {
-        pos[i].x = -max_pos;
-        vel[i].x *= -1.0f;
+    if (pos_i.x < -max_pos) {
+        pos_i.x = -max_pos;
+        vel_i.x *= -1.0f;
     }
 
-    if (pos[i].y > max_pos) {
-        pos[i].y = max_pos;
-        vel[i].y *= -1.0f;
+    if (pos_i.y > max_pos) {
+        pos_i.y = max_pos;
+        vel_i.y *= -1.0f;
     }
 
-    if (pos[i].y < -max_pos) {
-        pos[i].y = -max_pos;
-        vel[i].y *= -1.0f;
+    if (pos_i.y < -max_pos) {
+        pos_i.y = -max_pos;
+        vel_i.y *= -1.0f;
     }
+
+    pos[i].xy = pos_i;
+    STORE_VECTOR(vel_i, vel, i, VEL_UNIT);
 }
 
-kernel void velocities(global float2* vel, global float2* acc, const float dt, const float max_vel) {
+kernel void velocities(global VECTOR_STORAGE* vel, global VECTOR_STORAGE* acc, const float dt_arg, const float max_vel_arg, const uint n_arg) {
     unsigned long i = get_global_id(0);
+    if (i >= NUM_POINTS(n_arg)) {
+        return;
+    }
+
+    const float dt = TIME_STEP(dt_arg);
+    const float max_vel = MAX_VEL(max_vel_arg);
     const float dt_2 = dt / 2.0f;
 
-    vel[i] += dt_2 * acc[i];
+    float2 vel_i = LOAD_VECTOR(vel, i, VEL_UNIT) + dt_2 * LOAD_VECTOR(acc, i, ACC_UNIT);
 
-    if (length(vel[i]) > max_vel) {
-        vel[i] = max_vel * normalize(vel[i]);
+    if (length(vel_i) > max_vel) {
+        vel_i = max_vel * normalize(vel_i);
     }
+
+    STORE_VECTOR(vel_i, vel, i, VEL_UNIT);
 }
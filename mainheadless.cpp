@@ -0,0 +1,391 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include "nbodysim2d.h"
+#include "nbodycpusim2d.h"
+#include "nbodyconstants.h"
+#include "openclsources.h"
+
+using namespace NBodyConstants;
+
+static constexpr uint32_t ACCURACY_SAMPLES = 1024; // points checked against the double reference
+
+// Factor of attraction * mass * delta of the OpenCL force law, in double.
+static double forceFactor(double dist, NBodySim2D::ForceLaw force_law)
+{
+    if (force_law == NBodySim2D::ForceLaw::Plummer) {
+        return 1.0 / std::pow(dist * dist + static_cast<double>(RADIUS) * RADIUS, 1.5);
+    }
+
+    if ((force_law == NBodySim2D::ForceLaw::Spline) && (dist < RADIUS)) {
+        const double u = dist / RADIUS;
+        const double inv_rad_3 = 1.0 / (static_cast<double>(RADIUS) * RADIUS * RADIUS);
+        if (u < 0.5) {
+            return inv_rad_3 * (32.0 / 3.0 + u * u * (32.0 * u - 38.4));
+        }
+
+        return inv_rad_3 * (64.0 / 3.0 - 48.0 * u + 38.4 * u * u - 32.0 / 3.0 * u * u * u) - 1.0 / (15.0 * dist * dist * dist);
+    }
+
+    return ((force_law == NBodySim2D::ForceLaw::Spline) || (dist > RADIUS)) ? 1.0 / (dist * dist * dist) : 0.0;
+}
+
+// Accelerations of every num_points / ACCURACY_SAMPLES-th point, summed in double in the order of the points.
+static std::vector<double> referenceAccelerations(const std::vector<float>& locations, uint32_t num_points,
+    NBodySim2D::ForceLaw force_law)
+{
+    const uint32_t stride = std::max(num_points / ACCURACY_SAMPLES, 1u);
+    const uint32_t stride_floats = NBodyBackend2D::LOCATION_STRIDE;
+    std::vector<double> accelerations;
+    for (uint32_t i = 0; i < num_points; i += stride) {
+        double sum_x = 0.0;
+        double sum_y = 0.0;
+        for (uint32_t j = 0; j < num_points; j++) {
+            const double dx = static_cast<double>(locations[j * stride_floats]) - locations[i * stride_floats];
+            const double dy = static_cast<double>(locations[j * stride_floats + 1]) - locations[i * stride_floats + 1];
+            const double dist = std::sqrt(dx * dx + dy * dy);
+            if (j != i) {
+                const double factor = static_cast<double>(ATTRACTION) * locations[j * stride_floats + 2] * forceFactor(dist, force_law);
+                sum_x += factor * dx;
+                sum_y += factor * dy;
+            }
+        }
+
+        accelerations.push_back(sum_x);
+        accelerations.push_back(sum_y);
+    }
+
+    return accelerations;
+}
+
+static void printUsage(const char* program_name)
+{
+    std::cout << "Usage: " << program_name << " [options]\n"
+        << "  --backend=opencl|cpu                    simulation backend (default: opencl)\n"
+        << "  --isa=scalar|sse4|avx2|avx512           CPU gravity kernel (default: widest supported)\n"
+        << "  --solver=direct|symmetric|barnes-hut|radix-tree|fmm|pm|p3m\n"
+        << "                                          force solver (default: direct)\n"
+        << "  --theta=X                               Barnes-Hut opening angle (default: 0.5)\n"
+        << "  --fmm-order=N                           FMM expansion order (default: 6)\n"
+        << "  --pm-grid=N                             particle-mesh grid size (default: 256)\n"
+        << "  --pm-assignment=cic|tsc                 particle-mesh mass assignment (default: tsc)\n"
+        << "  --p3m-split=X                           P3M split radius in grid cells (default: 2)\n"
+        << "  --work-group-size=N                     OpenCL direct kernel tile size, 0 untiled (default: 256)\n"
+        << "  --autotune                              time the OpenCL launch configurations and keep the fastest\n"
+        << "  --profile-dir=DIR                       load the device's launch profile from DIR, --autotune stores it\n"
+        << "  --multi-device                          split the direct forces across every OpenCL device\n"
+        << "  --profile-kernels                       print the device time of every OpenCL command\n"
+        << "  --generic-kernels                       read the constants from kernel arguments, no specialisation\n"
+        << "  --precision=float|compensated|double    OpenCL force summation (default: float)\n"
+        << "  --accuracy-report                       run every --precision against a double reference and exit\n"
+        << "  --force-law=cutoff|plummer|spline       OpenCL force law, softened by the radius (default: cutoff)\n"
+        << "  --half-storage                          keep OpenCL velocities and accelerations as halves\n"
+        << "  --reorder-interval=N                    sort the OpenCL points in Z-order every N steps, 0 never\n"
+        << "                                          (default: 0)\n"
+        << "  --program-cache=DIR                     cache compiled OpenCL binaries in DIR (default: off)\n"
+        << "  --steps=N                               number of steps (default: 1000)\n"
+        << "  --points=N                              number of points\n"
+        << "  --masses=MIN:MAX                        Salpeter masses in sun masses (default: 1:1)\n"
+        << "  --output=FILE                           write final locations to FILE" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t num_steps = 1000;
+    uint32_t num_points = NUM_POINTS;
+    std::string output_file_name;
+    bool use_cpu_backend = false;
+    bool override_isa = false;
+    GravityKernels::Isa isa = GravityKernels::Isa::Scalar;
+    ForceSolverSettings2D force_solver_settings;
+    bool override_work_group_size = false;
+    size_t work_group_size = 0;
+    std::string program_cache_directory;
+    bool specialise_kernels = true;
+    bool autotune = false;
+    bool profile_kernels = false;
+    bool multi_device = false;
+    std::string profile_directory;
+    NBodySim2D::Precision precision = NBodySim2D::Precision::Float;
+    bool accuracy_report = false;
+    NBodySim2D::ForceLaw force_law = NBodySim2D::ForceLaw::Cutoff;
+    bool half_storage = false;
+    uint32_t reorder_interval = 0;
+    float min_mass = MIN_MASS;
+    float max_mass = MAX_MASS;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--backend=opencl") == 0) {
+            use_cpu_backend = false;
+        } else if (std::strcmp(argv[i], "--backend=cpu") == 0) {
+            use_cpu_backend = true;
+        } else if (std::strncmp(argv[i], "--isa=", 6) == 0) {
+            override_isa = true;
+            if (std::strcmp(argv[i] + 6, "scalar") == 0) {
+                isa = GravityKernels::Isa::Scalar;
+            } else if (std::strcmp(argv[i] + 6, "sse4") == 0) {
+                isa = GravityKernels::Isa::Sse4;
+            } else if (std::strcmp(argv[i] + 6, "avx2") == 0) {
+                isa = GravityKernels::Isa::Avx2;
+            } else if (std::strcmp(argv[i] + 6, "avx512") == 0) {
+                isa = GravityKernels::Isa::Avx512;
+            } else {
+                printUsage(argv[0]);
+                return EXIT_FAILURE;
+            }
+        } else if (std::strcmp(argv[i], "--solver=direct") == 0) {
+            force_solver_settings.method = ForceSolverSettings2D::Method::Direct;
+        } else if (std::strcmp(argv[i], "--solver=symmetric") == 0) {
+            force_solver_settings.method = ForceSolverSettings2D::Method::Symmetric;
+        } else if (std::strcmp(argv[i], "--solver=barnes-hut") == 0) {
+            force_solver_settings.method = ForceSolverSettings2D::Method::BarnesHut;
+        } else if (std::strcmp(argv[i], "--solver=radix-tree") == 0) {
+            force_solver_settings.method = ForceSolverSettings2D::Method::RadixTree;
+        } else if (std::strcmp(argv[i], "--solver=fmm") == 0) {
+            force_solver_settings.method = ForceSolverSettings2D::Method::Fmm;
+        } else if (std::strcmp(argv[i], "--solver=pm") == 0) {
+            force_solver_settings.method = ForceSolverSettings2D::Method::ParticleMesh;
+        } else if (std::strcmp(argv[i], "--solver=p3m") == 0) {
+            force_solver_settings.method = ForceSolverSettings2D::Method::P3m;
+        } else if (std::strncmp(argv[i], "--theta=", 8) == 0) {
+            force_solver_settings.barnes_hut_theta = std::strtof(argv[i] + 8, nullptr);
+        } else if (std::strncmp(argv[i], "--fmm-order=", 12) == 0) {
+            force_solver_settings.fmm_order = static_cast<uint32_t>(std::strtoul(argv[i] + 12, nullptr, 10));
+        } else if (std::strncmp(argv[i], "--pm-grid=", 10) == 0) {
+            force_solver_settings.pm_grid_size = static_cast<uint32_t>(std::strtoul(argv[i] + 10, nullptr, 10));
+        } else if (std::strcmp(argv[i], "--pm-assignment=cic") == 0) {
+            force_solver_settings.pm_mass_assignment = ForceSolverSettings2D::MassAssignment::Cic;
+        } else if (std::strcmp(argv[i], "--pm-assignment=tsc") == 0) {
+            force_solver_settings.pm_mass_assignment = ForceSolverSettings2D::MassAssignment::Tsc;
+        } else if (std::strncmp(argv[i], "--p3m-split=", 12) == 0) {
+            force_solver_settings.p3m_split_radius = std::strtof(argv[i] + 12, nullptr);
+        } else if (std::strncmp(argv[i], "--work-group-size=", 18) == 0) {
+            override_work_group_size = true;
+            work_group_size = std::strtoul(argv[i] + 18, nullptr, 10);
+        } else if (std::strcmp(argv[i], "--autotune") == 0) {
+            autotune = true;
+        } else if (std::strncmp(argv[i], "--profile-dir=", 14) == 0) {
+            profile_directory = argv[i] + 14;
+        } else if (std::strcmp(argv[i], "--multi-device") == 0) {
+            multi_device = true;
+        } else if (std::strcmp(argv[i], "--profile-kernels") == 0) {
+            profile_kernels = true;
+        } else if (std::strcmp(argv[i], "--generic-kernels") == 0) {
+            specialise_kernels = false;
+        } else if (std::strcmp(argv[i], "--precision=float") == 0) {
+            precision = NBodySim2D::Precision::Float;
+        } else if (std::strcmp(argv[i], "--precision=compensated") == 0) {
+            precision = NBodySim2D::Precision::Compensated;
+        } else if (std::strcmp(argv[i], "--precision=double") == 0) {
+            precision = NBodySim2D::Precision::Double;
+        } else if (std::strcmp(argv[i], "--accuracy-report") == 0) {
+            accuracy_report = true;
+        } else if (std::strcmp(argv[i], "--force-law=cutoff") == 0) {
+            force_law = NBodySim2D::ForceLaw::Cutoff;
+        } else if (std::strcmp(argv[i], "--force-law=plummer") == 0) {
+            force_law = NBodySim2D::ForceLaw::Plummer;
+        } else if (std::strcmp(argv[i], "--force-law=spline") == 0) {
+            force_law = NBodySim2D::ForceLaw::Spline;
+        } else if (std::strcmp(argv[i], "--half-storage") == 0) {
+            half_storage = true;
+        } else if (std::strncmp(argv[i], "--reorder-interval=", 19) == 0) {
+            reorder_interval = static_cast<uint32_t>(std::strtoul(argv[i] + 19, nullptr, 10));
+        } else if (std::strncmp(argv[i], "--program-cache=", 16) == 0) {
+            program_cache_directory = argv[i] + 16;
+        } else if (std::strncmp(argv[i], "--steps=", 8) == 0) {
+            num_steps = static_cast<uint32_t>(std::strtoul(argv[i] + 8, nullptr, 10));
+        } else if (std::strncmp(argv[i], "--points=", 9) == 0) {
+            num_points = static_cast<uint32_t>(std::strtoul(argv[i] + 9, nullptr, 10));
+        } else if (std::strncmp(argv[i], "--masses=", 9) == 0) {
+            char* separator = nullptr;
+            min_mass = std::strtof(argv[i] + 9, &separator);
+            if (*separator != ':') {
+                printUsage(argv[0]);
+                return EXIT_FAILURE;
+            }
+
+            max_mass = std::strtof(separator + 1, nullptr);
+        } else if (std::strncmp(argv[i], "--output=", 9) == 0) {
+            output_file_name = argv[i] + 9;
+        } else {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (num_points < 2) {
+        std::cerr << "At least two points are needed." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (!(min_mass > 0.0f) || !(max_mass >= min_mass)) {
+        std::cerr << "Masses must be positive, with MIN not above MAX." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<float> locations = NBodyBackend2D::generateRandomBodies(num_points, MAX_START_DISTANCE, min_mass, max_mass);
+    std::unique_ptr<NBodyBackend2D> nbodysim;
+    NBodySim2D* opencl_nbodysim_ptr = nullptr; // same object as nbodysim when the OpenCL backend runs
+    std::string error_message;
+
+    if (use_cpu_backend) {
+        std::unique_ptr<NBodyCpuSim2D> cpu_nbodysim = std::make_unique<NBodyCpuSim2D>();
+        cpu_nbodysim->setForceSolverSettings(force_solver_settings);
+        if (!cpu_nbodysim->init(locations, num_points, ATTRACTION, RADIUS, TIME_STEP,
+            MAX_DISTANCE, MAX_VELOCITY, MAX_START_VELOCITY, error_message)) {
+            std::cerr << error_message << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (override_isa) {
+            cpu_nbodysim->setIsa(isa);
+        }
+
+        std::cout << "CPU backend, " << GravityKernels::getIsaName(cpu_nbodysim->getIsa()) << " gravity kernel" << std::endl;
+        nbodysim = std::move(cpu_nbodysim);
+    } else {
+        std::vector<std::string> opencl_sources;
+        if (!OpenCLSources::load(opencl_sources, error_message)) {
+            std::cerr << error_message << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        auto init_opencl_nbodysim = [&](NBodySim2D& opencl_nbodysim, NBodySim2D::Precision run_precision) {
+            opencl_nbodysim.setForceSolverSettings(force_solver_settings);
+            if (override_work_group_size) {
+                opencl_nbodysim.setWorkGroupSize(work_group_size);
+            }
+
+            opencl_nbodysim.setSpecialiseKernels(specialise_kernels);
+            opencl_nbodysim.setPrecision(run_precision);
+            opencl_nbodysim.setForceLaw(force_law);
+            opencl_nbodysim.setHalfStorage(half_storage);
+            opencl_nbodysim.setReorderInterval(reorder_interval);
+            opencl_nbodysim.setProfileDirectory(profile_directory);
+            opencl_nbodysim.setAutotune(autotune);
+            opencl_nbodysim.setProfiling(profile_kernels);
+            opencl_nbodysim.setMultiDevice(multi_device);
+            opencl_nbodysim.setProgramCacheDirectory(program_cache_directory);
+            return opencl_nbodysim.initHeadless(opencl_sources, locations, num_points, ATTRACTION, RADIUS, TIME_STEP,
+                MAX_DISTANCE, MAX_VELOCITY, MAX_START_VELOCITY, error_message);
+        };
+
+        if (accuracy_report) {
+            // error of the initial accelerations, then the speed of num_steps steps
+            const std::vector<double> reference = referenceAccelerations(locations, num_points, force_law);
+            const uint32_t stride = std::max(num_points / ACCURACY_SAMPLES, 1u);
+            const std::pair<NBodySim2D::Precision, const char*> precisions[] = {
+                { NBodySim2D::Precision::Float, "float" },
+                { NBodySim2D::Precision::Compensated, "compensated" },
+                { NBodySim2D::Precision::Double, "double" }
+            };
+
+            for (const auto& [run_precision, name] : precisions) {
+                NBodySim2D opencl_nbodysim;
+                std::vector<float> accelerations;
+                if (!init_opencl_nbodysim(opencl_nbodysim, run_precision) ||
+                    !opencl_nbodysim.readAccelerations(accelerations, error_message)) {
+                    std::cout << name << ": " << error_message << std::endl;
+                    continue;
+                }
+
+                double max_error = 0.0;
+                double sum_squared_error = 0.0;
+                for (size_t k = 0; k < reference.size() / 2; k++) {
+                    const size_t i = k * stride;
+                    const double magnitude = std::hypot(reference[k * 2], reference[k * 2 + 1]);
+                    const double error = std::hypot(accelerations[i * 2] - reference[k * 2],
+                        accelerations[i * 2 + 1] - reference[k * 2 + 1]) / std::max(magnitude, 1.0e-30);
+                    max_error = std::max(max_error, error);
+                    sum_squared_error += error * error;
+                }
+
+                auto start_time = std::chrono::steady_clock::now();
+                if (!opencl_nbodysim.updateLocations(num_points, num_steps, error_message) ||
+                    !opencl_nbodysim.waitForLocations(error_message)) {
+                    std::cerr << error_message << std::endl;
+                    return EXIT_FAILURE;
+                }
+
+                std::chrono::duration<double> elapsed_time = std::chrono::steady_clock::now() - start_time;
+                std::cout << name << ": relative error " << max_error << " max, "
+                    << std::sqrt(sum_squared_error / static_cast<double>(reference.size() / 2)) << " rms, "
+                    << static_cast<double>(num_steps) * num_points * num_points / elapsed_time.count()
+                    << " interactions/s" << std::endl;
+            }
+
+            return EXIT_SUCCESS;
+        }
+
+        std::unique_ptr<NBodySim2D> opencl_nbodysim = std::make_unique<NBodySim2D>();
+        if (!init_opencl_nbodysim(*opencl_nbodysim, precision)) {
+            std::cerr << error_message << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        // the ranking shows why the device was chosen
+        const std::vector<OpenCLDeviceInfo>& device_ranking = opencl_nbodysim->getDeviceRanking();
+        for (size_t i = 0; i < device_ranking.size(); i++) {
+            const OpenCLDeviceInfo& device = device_ranking[i];
+            std::cout << ((i == opencl_nbodysim->getSelectedDevice()) ? "* " : "  ") << device.device_name << " ("
+                << device.platform_name << "): " << device.benchmark_rate << " interactions/s, "
+                << device.compute_units << " compute units at " << device.clock_frequency << " MHz" << std::endl;
+        }
+
+        const LaunchProfile& launch_profile = opencl_nbodysim->getLaunchProfile();
+        std::cout << "OpenCL backend, work-group size " << launch_profile.work_group_size << ", unroll "
+            << launch_profile.unroll << ", leapfrog work-group size " << launch_profile.leapfrog_work_group_size
+            << ", " << opencl_nbodysim->getNumDevices() << " device(s)" << std::endl;
+        opencl_nbodysim_ptr = opencl_nbodysim.get();
+        nbodysim = std::move(opencl_nbodysim);
+    }
+
+    auto start_time = std::chrono::steady_clock::now();
+
+    if (!nbodysim->updateLocations(num_points, num_steps, error_message) ||
+        !nbodysim->waitForLocations(error_message)) {
+        std::cerr << error_message << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (!nbodysim->readLocations(locations, error_message)) {
+        std::cerr << error_message << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::chrono::duration<double> elapsed_time = std::chrono::steady_clock::now() - start_time;
+    std::cout << num_steps << " steps of " << num_points << " points in " << elapsed_time.count() << " s";
+    if ((force_solver_settings.method == ForceSolverSettings2D::Method::Direct) ||
+        (force_solver_settings.method == ForceSolverSettings2D::Method::Symmetric)) {
+        // every step evaluates the accelerations once, the symmetric solver counts each pair for both points
+        double num_interactions = static_cast<double>(num_steps) * num_points * num_points;
+        std::cout << " (" << num_interactions / elapsed_time.count() << " interactions/s)";
+    }
+    std::cout << std::endl;
+
+    if (opencl_nbodysim_ptr != nullptr) {
+        for (const CommandProfiler::CommandStats& stats : opencl_nbodysim_ptr->getProfilingStats()) {
+            std::cout << "  " << stats.name << ": " << stats.launches << " launches, " << stats.run_time << " s running, "
+                << stats.queued_time << " s queued and " << stats.submit_time << " s submitted per launch" << std::endl;
+        }
+    }
+
+    if (!output_file_name.empty()) {
+        std::ofstream output_file(output_file_name);
+        if (!output_file) {
+            std::cerr << "Cannot open output file (" << output_file_name << ")." << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        for (size_t i = 0; i < locations.size(); i += NBodyBackend2D::LOCATION_STRIDE) {
+            output_file << locations[i] << " " << locations[i + 1] << "\n";
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
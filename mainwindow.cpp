@@ -1,12 +1,19 @@
-#include <QFile>
 #include <QMessageBox>
+#include <QStandardPaths>
+#include <QStringList>
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "nbodysim2d.h"
+#include "nbodycpusim2d.h"
+#include "openclsources.h"
+
+using namespace NBodyConstants;
 
 MainWindow::MainWindow(QWidget* parent) :
     QMainWindow(parent),
     m_ui(new Ui::MainWindow),
-    m_rendering_timer(new QTimer(this))
+    m_rendering_timer(new QTimer(this)),
+    m_step_scheduler(RENDER_UPDATE_TIME_MS / 1000.0, SIMULATION_FRAME_FRACTION, MAX_STEPS_PER_FRAME)
 {
     m_ui->setupUi(this);
 
@@ -25,6 +32,9 @@ MainWindow::MainWindow(QWidget* parent) :
     connect(m_rendering_timer, &QTimer::timeout,
         this, &MainWindow::rendering_timer_timeout,
         Qt::ConnectionType::QueuedConnection);
+
+    connect(m_ui->action_profiling, &QAction::toggled,
+        this, &MainWindow::action_profiling_toggled);
 }
 
 MainWindow::~MainWindow()
@@ -52,7 +62,7 @@ void MainWindow::openglSceneWidget_openGlInitialized()
     error_dialog.setModal(true);
     error_dialog.setTextInteractionFlags(Qt::TextSelectableByMouse);
 
-    std::vector<float> vertices_data = NBodySim2D::generateRandomLocations(NUM_POINTS, MAX_START_DISTANCE);
+    std::vector<float> vertices_data = NBodyBackend2D::generateRandomBodies(NUM_POINTS, MAX_START_DISTANCE, MIN_MASS, MAX_MASS);
 
     QString error_message_1;
     if (!m_ui->central_widget->initVertices(vertices_data, error_message_1)) {
@@ -63,40 +73,55 @@ void MainWindow::openglSceneWidget_openGlInitialized()
         return;
     }
 
-    QFile opencl_source_file_gravity(":/gravity.cl");
-    if (!opencl_source_file_gravity.open(QIODevice::ReadOnly)) {
-        error_dialog.setWindowTitle("OpenCL error");
-        error_dialog.setText("Cannot open OpenCL source file.");
-        error_dialog.exec();
-        QApplication::quit();
-        return;
-    }
-
     std::vector<std::string> opencl_sources;
-    opencl_sources.push_back(opencl_source_file_gravity.readAll().toStdString());
-    opencl_source_file_gravity.close();
-
-    QFile opencl_source_file_leapfrog(":/leapfrog.cl");
-    if (!opencl_source_file_leapfrog.open(QIODevice::ReadOnly)) {
+    std::string error_message_2;
+    if (!OpenCLSources::load(opencl_sources, error_message_2)) {
         error_dialog.setWindowTitle("OpenCL error");
-        error_dialog.setText("Cannot open OpenCL source file.");
+        error_dialog.setText(error_message_2.c_str());
         error_dialog.exec();
         QApplication::quit();
         return;
     }
 
-    opencl_sources.push_back(opencl_source_file_leapfrog.readAll().toStdString());
-    opencl_source_file_leapfrog.close();
+    std::vector<cl_GLuint> vertex_buffer_ids;
+    for (int i = 0; i < OpenGLSceneWidget::NUM_VERTEX_BUFFERS; i++) {
+        vertex_buffer_ids.push_back(m_ui->central_widget->getVertexBufferId(i));
+    }
 
-    std::string error_message_2;
-    if (!m_nbodysim.init(opencl_sources, m_ui->central_widget->getVertexBufferId(),
-        static_cast<uint32_t>(vertices_data.size()), ATTRACTION, RADIUS, TIME_STEP,
-        MAX_DISTANCE, MAX_VELOCITY, MAX_START_VELOCITY, error_message_2)) {
-        error_dialog.setWindowTitle("OpenCL error");
-        error_dialog.setText(error_message_2.c_str());
-        error_dialog.exec();
-        QApplication::quit();
-        return;
+    std::unique_ptr<NBodySim2D> opencl_nbodysim = std::make_unique<NBodySim2D>();
+    opencl_nbodysim->setProgramCacheDirectory(
+        (QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/opencl").toStdString());
+    opencl_nbodysim->setProfileDirectory(
+        (QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/profiles").toStdString());
+    if (opencl_nbodysim->init(opencl_sources, vertex_buffer_ids,
+        NUM_POINTS, ATTRACTION, RADIUS, TIME_STEP, MAX_DISTANCE, MAX_VELOCITY,
+        MAX_START_VELOCITY, error_message_2)) {
+        m_opencl_nbodysim = opencl_nbodysim.get();
+        m_nbodysim = std::move(opencl_nbodysim);
+        m_ui->action_profiling->setEnabled(true);
+
+        const OpenCLDeviceInfo& device = m_opencl_nbodysim->getDeviceRanking()[m_opencl_nbodysim->getSelectedDevice()];
+        m_ui->status_bar->showMessage(QString("Running on %1 (%2), ranked %3 of %4 OpenCL devices at %5 interactions/s")
+            .arg(device.device_name.c_str())
+            .arg(device.platform_name.c_str())
+            .arg(m_opencl_nbodysim->getSelectedDevice() + 1)
+            .arg(m_opencl_nbodysim->getDeviceRanking().size())
+            .arg(device.benchmark_rate, 0, 'g', 3));
+    } else {
+        // fall back to the native CPU backend on hosts without a usable OpenCL runtime
+        m_ui->status_bar->showMessage(QString("OpenCL unavailable, running on CPU. ") + error_message_2.c_str());
+
+        std::unique_ptr<NBodyCpuSim2D> cpu_nbodysim = std::make_unique<NBodyCpuSim2D>();
+        if (!cpu_nbodysim->init(vertices_data, NUM_POINTS, ATTRACTION, RADIUS, TIME_STEP,
+            MAX_DISTANCE, MAX_VELOCITY, MAX_START_VELOCITY, error_message_2)) {
+            error_dialog.setWindowTitle("Simulation error");
+            error_dialog.setText(error_message_2.c_str());
+            error_dialog.exec();
+            QApplication::quit();
+            return;
+        }
+
+        m_nbodysim = std::move(cpu_nbodysim);
     }
 
     m_rendering_timer->setSingleShot(false);
@@ -114,17 +139,104 @@ void MainWindow::openglSceneWidget_openGlDestroyed()
 
 void MainWindow::rendering_timer_timeout()
 {
+    // the previous batch has usually finished while the last frame was shown, then this does not block
     std::string error_message;
-    if (!m_nbodysim.updateLocations(NUM_POINTS, error_message)) {
+    if (!m_nbodysim->waitForLocations(error_message)) {
         QMessageBox error_dialog(this);
         error_dialog.setIcon(QMessageBox::Icon::Critical);
         error_dialog.setModal(true);
         error_dialog.setTextInteractionFlags(Qt::TextSelectableByMouse);
-        error_dialog.setWindowTitle("OpenCL error");
+        error_dialog.setWindowTitle("Simulation error");
+        error_dialog.setText(error_message.c_str());
+        error_dialog.exec();
+        QApplication::quit();
+        return;
+    }
+
+    // the finished batch becomes visible, the next one goes into the other vertex buffer
+    if (m_opencl_nbodysim != nullptr) {
+        m_ui->central_widget->setFrontBuffer(static_cast<int>(m_opencl_nbodysim->getFrontBufferIndex()));
+    }
+
+    if ((m_num_steps > 0) && (m_nbodysim->getLastBatchTime() > 0.0)) {
+        m_step_scheduler.addMeasurement(m_num_steps, m_nbodysim->getLastBatchTime());
+    }
+
+    if ((m_opencl_nbodysim != nullptr) && m_ui->action_profiling->isChecked()) {
+        showProfilingStats();
+    }
+
+    // the number of steps per frame follows the measured speed, rendering shows the latest state only
+    m_num_steps = m_step_scheduler.getNumSteps();
+
+    if (m_opencl_nbodysim != nullptr) {
+        m_opencl_nbodysim->setGlFence(m_ui->central_widget->getDrawFence());
+    }
+
+    if (!m_nbodysim->updateLocations(NUM_POINTS, m_num_steps, error_message)) {
+        QMessageBox error_dialog(this);
+        error_dialog.setIcon(QMessageBox::Icon::Critical);
+        error_dialog.setModal(true);
+        error_dialog.setTextInteractionFlags(Qt::TextSelectableByMouse);
+        error_dialog.setWindowTitle("Simulation error");
         error_dialog.setText(error_message.c_str());
         error_dialog.exec();
         QApplication::quit();
+        return;
+    }
+
+    if (!m_nbodysim->sharesVertexBuffer()) {
+        std::vector<float> vertices_data;
+        if (!m_nbodysim->readLocations(vertices_data, error_message)) {
+            QMessageBox error_dialog(this);
+            error_dialog.setIcon(QMessageBox::Icon::Critical);
+            error_dialog.setModal(true);
+            error_dialog.setTextInteractionFlags(Qt::TextSelectableByMouse);
+            error_dialog.setWindowTitle("Simulation error");
+            error_dialog.setText(error_message.c_str());
+            error_dialog.exec();
+            QApplication::quit();
+            return;
+        }
+
+        QString error_message_2;
+        if (!m_ui->central_widget->updateVertices(vertices_data, error_message_2)) {
+            QMessageBox error_dialog(this);
+            error_dialog.setIcon(QMessageBox::Icon::Critical);
+            error_dialog.setModal(true);
+            error_dialog.setTextInteractionFlags(Qt::TextSelectableByMouse);
+            error_dialog.setWindowTitle("OpenGL error");
+            error_dialog.setText(error_message_2);
+            error_dialog.exec();
+            QApplication::quit();
+            return;
+        }
     }
 
     m_ui->central_widget->update();
 }
+
+void MainWindow::action_profiling_toggled(bool checked)
+{
+    if (m_opencl_nbodysim == nullptr) {
+        return;
+    }
+
+    m_opencl_nbodysim->setProfiling(checked);
+    m_ui->status_bar->clearMessage();
+}
+
+void MainWindow::showProfilingStats()
+{
+    // device time per batch and launches per batch of every command, then the mean wait before each launch
+    QStringList command_texts;
+    for (const CommandProfiler::CommandStats& stats : m_opencl_nbodysim->getProfilingStats()) {
+        command_texts.append(QString("%1 %2 ms (%3x, wait %4 ms)")
+            .arg(stats.name.c_str())
+            .arg(stats.run_time * 1000.0, 0, 'f', 3)
+            .arg(stats.launches, 0, 'f', 1)
+            .arg((stats.queued_time + stats.submit_time) * 1000.0, 0, 'f', 3));
+    }
+
+    m_ui->status_bar->showMessage(command_texts.join(", "));
+}
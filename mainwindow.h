@@ -3,7 +3,12 @@
 
 #include <QMainWindow>
 #include <QTimer>
-#include "nbodysim2d.h"
+#include <memory>
+#include "nbodybackend2d.h"
+#include "nbodyconstants.h"
+#include "stepscheduler.h"
+
+class NBodySim2D;
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -19,25 +24,25 @@ public:
     ~MainWindow();
 
 private:
-    static constexpr uint32_t NUM_POINTS = 1000;
-    static constexpr float ATTRACTION = 1.5e-16f; // Newton's gravity constant * Sun's mass [light years^3 / sun mass / year^2]
-    static constexpr float RADIUS = 7.0e-8f; // Sun's radius [light years]
-    static constexpr float TIME_STEP = 100000.0f; // years
-    static constexpr float MAX_VELOCITY = 0.3f; // light speed [light years / years]
-    static constexpr float MAX_DISTANCE = 10000.0f; // [light years]
-    static constexpr float MAX_START_VELOCITY = 0.0001f; // 100m/s [light years / years]
-    static constexpr float MAX_START_DISTANCE = 5000.0f; // [light years]
     static constexpr int RENDER_UPDATE_TIME_MS = 100;
+    static constexpr double SIMULATION_FRAME_FRACTION = 0.5; // share of each frame spent simulating
+    static constexpr uint32_t MAX_STEPS_PER_FRAME = 64;
 
     Ui::MainWindow* m_ui;
-    NBodySim2D m_nbodysim;
+    std::unique_ptr<NBodyBackend2D> m_nbodysim;
+    NBodySim2D* m_opencl_nbodysim = nullptr; // same object as m_nbodysim when the OpenCL backend runs
     QTimer* m_rendering_timer;
+    StepScheduler m_step_scheduler;
+    uint32_t m_num_steps = 0; // steps of the batch in flight
+
+    void showProfilingStats();
 
 private slots:
     void openglSceneWidget_errorOccurred(const QString& error_message);
     void openglSceneWidget_openGlInitialized();
     void openglSceneWidget_openGlDestroyed();
     void rendering_timer_timeout();
+    void action_profiling_toggled(bool checked);
 };
 
 #endif // MAINWINDOW_H
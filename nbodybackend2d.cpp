@@ -0,0 +1,56 @@
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include "nbodybackend2d.h"
+
+
+std::vector<float> NBodyBackend2D::generateRandomLocations(uint32_t num_points, float max_value)
+{
+    std::vector<float> vertices_data(num_points * 2);
+    std::random_device rand_device;
+    std::seed_seq rand_seed{ rand_device(), rand_device(), rand_device(), rand_device(), rand_device() };
+    std::mt19937 rand_gen(rand_seed);
+    std::uniform_real_distribution<float> rand_dist(-max_value, max_value);
+    std::generate(vertices_data.begin(), vertices_data.end(), std::bind(rand_dist, rand_gen));
+    return vertices_data;
+}
+
+
+std::vector<float> NBodyBackend2D::generateRandomBodies(uint32_t num_points, float max_distance, float min_mass,
+    float max_mass)
+{
+    static constexpr double SALPETER_SLOPE = 2.35; // dN/dm ~ m^-2.35
+
+    std::vector<float> locations = generateRandomLocations(num_points, max_distance);
+    std::vector<float> bodies(num_points * LOCATION_STRIDE, 0.0f);
+    std::random_device rand_device;
+    std::mt19937 rand_gen(rand_device());
+    std::uniform_real_distribution<double> rand_dist(0.0, 1.0);
+
+    // inverse transform sampling of the truncated power law
+    const double exponent = 1.0 - SALPETER_SLOPE;
+    const double low = std::pow(static_cast<double>(min_mass), exponent);
+    const double high = std::pow(static_cast<double>(max_mass), exponent);
+
+    for (uint32_t i = 0; i < num_points; i++) {
+        bodies[i * LOCATION_STRIDE] = locations[i * 2];
+        bodies[i * LOCATION_STRIDE + 1] = locations[i * 2 + 1];
+        bodies[i * LOCATION_STRIDE + 2] = (min_mass < max_mass) ?
+            static_cast<float>(std::pow(low + (high - low) * rand_dist(rand_gen), 1.0 / exponent)) : min_mass;
+    }
+
+    return bodies;
+}
+
+
+void NBodyBackend2D::setForceSolverSettings(const ForceSolverSettings2D& settings)
+{
+    m_force_solver_settings = settings;
+}
+
+
+const ForceSolverSettings2D& NBodyBackend2D::getForceSolverSettings() const
+{
+    return m_force_solver_settings;
+}
@@ -0,0 +1,47 @@
+#ifndef NBODYBACKEND2D_H
+#define NBODYBACKEND2D_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "forcesolver2d.h"
+
+// Common interface of the simulation backends. Initialisation is backend specific.
+class NBodyBackend2D {
+public:
+    // Floats per point of the locations: x, y, mass and one unused, so that a point is one float4 on the device.
+    static constexpr uint32_t LOCATION_STRIDE = 4;
+
+    // num_points random 2D vectors, two floats per point.
+    static std::vector<float> generateRandomLocations(uint32_t num_points, float max_value);
+    // Points at random locations with masses from a Salpeter distribution between min_mass and max_mass,
+    // in the LOCATION_STRIDE layout.
+    static std::vector<float> generateRandomBodies(uint32_t num_points, float max_distance, float min_mass,
+        float max_mass);
+
+    virtual ~NBodyBackend2D() = default;
+
+    // Runs num_steps steps back to back and synchronises with the host only once, at the end.
+    virtual bool updateLocations(uint32_t num_points, uint32_t num_steps, std::string& error_message) = 0;
+    // In the LOCATION_STRIDE layout.
+    virtual bool readLocations(std::vector<float>& locations, std::string& error_message) = 0;
+
+    // updateLocations may return before the steps are done. Blocks until the last batch is complete and,
+    // for a shared vertex buffer, released back to OpenGL.
+    virtual bool waitForLocations(std::string& error_message) = 0;
+
+    // Duration of the last completed batch in seconds, 0 if not known.
+    virtual double getLastBatchTime() const = 0;
+
+    // True if the backend writes the locations directly into the OpenGL vertex buffer.
+    virtual bool sharesVertexBuffer() const = 0;
+
+    // Takes effect on the next init.
+    void setForceSolverSettings(const ForceSolverSettings2D& settings);
+    const ForceSolverSettings2D& getForceSolverSettings() const;
+
+protected:
+    ForceSolverSettings2D m_force_solver_settings;
+};
+
+#endif // NBODYBACKEND2D_H
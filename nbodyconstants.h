@@ -0,0 +1,19 @@
+#ifndef NBODYCONSTANTS_H
+#define NBODYCONSTANTS_H
+
+#include <cstdint>
+
+namespace NBodyConstants {
+    constexpr uint32_t NUM_POINTS = 1000;
+    constexpr float ATTRACTION = 1.5e-16f; // Newton's gravity constant * Sun's mass [light years^3 / sun mass / year^2]
+    constexpr float RADIUS = 7.0e-8f; // Sun's radius [light years]
+    constexpr float TIME_STEP = 100000.0f; // years
+    constexpr float MAX_VELOCITY = 0.3f; // light speed [light years / years]
+    constexpr float MAX_DISTANCE = 10000.0f; // [light years]
+    constexpr float MAX_START_VELOCITY = 0.0001f; // 100m/s [light years / years]
+    constexpr float MAX_START_DISTANCE = 5000.0f; // [light years]
+    constexpr float MIN_MASS = 1.0f; // [sun masses]
+    constexpr float MAX_MASS = 1.0f; // [sun masses]
+}
+
+#endif // NBODYCONSTANTS_H
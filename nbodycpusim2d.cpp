@@ -0,0 +1,204 @@
+#include <chrono>
+#include <cmath>
+#include "nbodycpusim2d.h"
+
+
+bool NBodyCpuSim2D::init(const std::vector<float>& locations, uint32_t num_points, float attraction, float radius,
+    float time_step, float max_pos, float max_vel, float max_start_vel, std::string& error_message)
+{
+    if (locations.size() != num_points * LOCATION_STRIDE) {
+        error_message = "Number of locations does not match number of points.";
+        return false;
+    }
+
+    if (m_force_solver_settings.method == ForceSolverSettings2D::Method::RadixTree) {
+        error_message = "Radix tree solver needs the OpenCL backend.";
+        return false;
+    }
+
+    std::vector<float> velocities = generateRandomLocations(num_points, max_start_vel);
+
+    m_pos_x.resize(num_points);
+    m_pos_y.resize(num_points);
+    m_vel_x.resize(num_points);
+    m_vel_y.resize(num_points);
+    m_mass.resize(num_points);
+    for (uint32_t i = 0; i < num_points; i++) {
+        m_pos_x[i] = locations[i * LOCATION_STRIDE];
+        m_pos_y[i] = locations[i * LOCATION_STRIDE + 1];
+        m_mass[i] = locations[i * LOCATION_STRIDE + 2];
+        m_vel_x[i] = velocities[i * 2];
+        m_vel_y[i] = velocities[i * 2 + 1];
+    }
+
+    m_acc_x.assign(num_points, 0.0f);
+    m_acc_y.assign(num_points, 0.0f);
+    m_attraction = attraction;
+    m_radius = radius;
+    m_time_step = time_step;
+    m_max_pos = max_pos;
+    m_max_vel = max_vel;
+
+    GravityKernels::Isa isa = GravityKernels::detectIsa();
+    if (GravityKernels::compareToScalar(isa, m_pos_x.data(), m_pos_y.data(), m_mass.data(), num_points, ISA_CHECK_NUM_SAMPLES,
+        m_attraction, radius) > ISA_CHECK_MAX_ERROR) {
+        isa = GravityKernels::Isa::Scalar;
+    }
+
+    setIsa(isa);
+
+    m_force_solver = ForceSolver2D::create(m_force_solver_settings, m_thread_pool, m_attraction, radius);
+
+    // prime the accelerations, every step then needs only one force evaluation
+    accelerations();
+    return true;
+}
+
+
+bool NBodyCpuSim2D::updateLocations(uint32_t num_points, uint32_t num_steps, std::string& error_message)
+{
+    if (m_pos_x.size() != num_points) {
+        error_message = "Number of points does not match the initialised simulation.";
+        return false;
+    }
+
+    auto start_time = std::chrono::steady_clock::now();
+
+    for (uint32_t step = 0; step < num_steps; step++) {
+        // kick-drift-kick: the first half kick uses the accelerations left from the previous step (or init)
+        m_thread_pool.parallelFor(num_points, [this](size_t begin, size_t end) { positions(begin, end); });
+        accelerations();
+        m_thread_pool.parallelFor(num_points, [this](size_t begin, size_t end) { velocities(begin, end); });
+    }
+
+    m_last_batch_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    return true;
+}
+
+
+bool NBodyCpuSim2D::readLocations(std::vector<float>& locations, std::string& error_message)
+{
+    (void)error_message;
+
+    locations.assign(m_pos_x.size() * LOCATION_STRIDE, 0.0f);
+    for (size_t i = 0; i < m_pos_x.size(); i++) {
+        locations[i * LOCATION_STRIDE] = m_pos_x[i];
+        locations[i * LOCATION_STRIDE + 1] = m_pos_y[i];
+        locations[i * LOCATION_STRIDE + 2] = m_mass[i];
+    }
+
+    return true;
+}
+
+
+bool NBodyCpuSim2D::waitForLocations(std::string& error_message)
+{
+    (void)error_message;
+
+    // updateLocations runs synchronously
+    return true;
+}
+
+
+double NBodyCpuSim2D::getLastBatchTime() const
+{
+    return m_last_batch_time;
+}
+
+
+bool NBodyCpuSim2D::sharesVertexBuffer() const
+{
+    return false;
+}
+
+
+void NBodyCpuSim2D::setIsa(GravityKernels::Isa isa)
+{
+    m_isa = isa;
+    m_gravity_function = GravityKernels::getFunction(isa);
+}
+
+
+GravityKernels::Isa NBodyCpuSim2D::getIsa() const
+{
+    return m_isa;
+}
+
+
+void NBodyCpuSim2D::accelerations()
+{
+    if (m_force_solver) {
+        m_force_solver->computeAccelerations(m_pos_x, m_pos_y, m_mass, m_acc_x, m_acc_y);
+        return;
+    }
+
+    m_thread_pool.parallelFor(m_pos_x.size(), [this](size_t begin, size_t end) {
+        m_gravity_function(m_pos_x.data(), m_pos_y.data(), m_mass.data(), m_pos_x.size(), begin, end, m_attraction, m_radius,
+            m_acc_x.data(), m_acc_y.data());
+    });
+}
+
+
+void NBodyCpuSim2D::positions(size_t begin, size_t end)
+{
+    const float dt_2 = m_time_step / 2.0f;
+
+    for (size_t i = begin; i < end; i++) {
+        float& pos_x = m_pos_x[i];
+        float& pos_y = m_pos_y[i];
+        float& vel_x = m_vel_x[i];
+        float& vel_y = m_vel_y[i];
+
+        vel_x += dt_2 * m_acc_x[i];
+        vel_y += dt_2 * m_acc_y[i];
+
+        float vel = std::sqrt(vel_x * vel_x + vel_y * vel_y);
+        if (vel > m_max_vel) {
+            vel_x *= m_max_vel / vel;
+            vel_y *= m_max_vel / vel;
+        }
+
+        pos_x += m_time_step * vel_x;
+        pos_y += m_time_step * vel_y;
+
+        if (pos_x > m_max_pos) {
+            pos_x = m_max_pos;
+            vel_x *= -1.0f;
+        }
+
+        if (pos_x < -m_max_pos) {
+            pos_x = -m_max_pos;
+            vel_x *= -1.0f;
+        }
+
+        if (pos_y > m_max_pos) {
+            pos_y = m_max_pos;
+            vel_y *= -1.0f;
+        }
+
+        if (pos_y < -m_max_pos) {
+            pos_y = -m_max_pos;
+            vel_y *= -1.0f;
+        }
+    }
+}
+
+
+void NBodyCpuSim2D::velocities(size_t begin, size_t end)
+{
+    const float dt_2 = m_time_step / 2.0f;
+
+    for (size_t i = begin; i < end; i++) {
+        float& vel_x = m_vel_x[i];
+        float& vel_y = m_vel_y[i];
+
+        vel_x += dt_2 * m_acc_x[i];
+        vel_y += dt_2 * m_acc_y[i];
+
+        float vel = std::sqrt(vel_x * vel_x + vel_y * vel_y);
+        if (vel > m_max_vel) {
+            vel_x *= m_max_vel / vel;
+            vel_y *= m_max_vel / vel;
+        }
+    }
+}
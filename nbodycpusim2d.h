@@ -0,0 +1,52 @@
+#ifndef NBODYCPUSIM2D_H
+#define NBODYCPUSIM2D_H
+
+#include "nbodybackend2d.h"
+#include "gravitykernels.h"
+#include "threadpool.h"
+
+// Native C++ backend. Reproduces the "accelerations", "positions" and "velocities" OpenCL kernels
+// on all CPU cores and serves as a reference for the OpenCL output.
+class NBodyCpuSim2D : public NBodyBackend2D {
+public:
+    // Picks the widest instruction set the CPU supports, unless it disagrees with the scalar kernel.
+    bool init(const std::vector<float>& locations, uint32_t num_points, float attraction, float radius,
+        float time_step, float max_pos, float max_vel, float max_start_vel, std::string& error_message);
+
+    bool updateLocations(uint32_t num_points, uint32_t num_steps, std::string& error_message) override;
+    bool readLocations(std::vector<float>& locations, std::string& error_message) override;
+    bool waitForLocations(std::string& error_message) override;
+    double getLastBatchTime() const override;
+    bool sharesVertexBuffer() const override;
+
+    void setIsa(GravityKernels::Isa isa);
+    GravityKernels::Isa getIsa() const;
+
+private:
+    static constexpr size_t ISA_CHECK_NUM_SAMPLES = 64;
+    static constexpr float ISA_CHECK_MAX_ERROR = 1.0e-3f;
+
+    ThreadPool m_thread_pool;
+    std::unique_ptr<ForceSolver2D> m_force_solver;
+    GravityKernels::Isa m_isa = GravityKernels::Isa::Scalar;
+    GravityKernels::Function m_gravity_function = GravityKernels::accelerationsScalar;
+    std::vector<float> m_pos_x;
+    std::vector<float> m_pos_y;
+    std::vector<float> m_vel_x;
+    std::vector<float> m_vel_y;
+    std::vector<float> m_acc_x;
+    std::vector<float> m_acc_y;
+    std::vector<float> m_mass;
+    float m_attraction = 0.0f;
+    float m_radius = 0.0f;
+    float m_time_step = 0.0f;
+    float m_max_pos = 0.0f;
+    float m_max_vel = 0.0f;
+    double m_last_batch_time = 0.0;
+
+    void accelerations();
+    void positions(size_t begin, size_t end);
+    void velocities(size_t begin, size_t end);
+};
+
+#endif // NBODYCPUSIM2D_H
@@ -1,7 +1,11 @@
-#include <random>
 #include <algorithm>
-#include <functional>
+#include <cmath>
+#include <cstdio>
+#include <limits>
 #include "nbodysim2d.h"
+#include "opencldevices.h"
+#include "openclprogramcache.h"
+#include <CL/cl_half.h>
 
 
 #ifdef _WIN32
@@ -14,259 +18,665 @@
 #endif
 
 
-std::vector<float> NBodySim2D::generateRandomLocations(uint32_t num_points, float max_value)
+static bool createKernel(const cl::Program& ocl_program, const char* name, cl::Kernel& ocl_kernel, std::string& error_message)
 {
-    std::vector<float> vertices_data(num_points * 2);
-    std::random_device rand_device;
-    std::seed_seq rand_seed{ rand_device(), rand_device(), rand_device(), rand_device(), rand_device() };
-    std::mt19937 rand_gen(rand_seed);
-    std::uniform_real_distribution<float> rand_dist(-max_value, max_value);
-    std::generate(vertices_data.begin(), vertices_data.end(), std::bind(rand_dist, rand_gen));
-    return vertices_data;
+    cl_int ocl_err;
+    ocl_kernel = cl::Kernel(ocl_program, name, &ocl_err);
+    if (ocl_err != CL_SUCCESS) {
+        error_message = std::string("Cannot create OpenCL kernel (") + name + "). Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    return true;
+}
+
+template<typename T>
+static bool setKernelArg(cl::Kernel& ocl_kernel, cl_uint index, const T& value, const char* description, std::string& error_message)
+{
+    cl_int ocl_err = ocl_kernel.setArg(index, value);
+    if (ocl_err != CL_SUCCESS) {
+        error_message = std::string("Cannot add argument to OpenCL kernel (") + description + "). Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    return true;
+}
+
+// Moves the values of every slot, stride floats each, to the external id of the point in that slot.
+static void restoreIdOrder(const std::vector<uint32_t>& ids, size_t stride, std::vector<float>& values)
+{
+    std::vector<float> ordered(values.size());
+    for (size_t k = 0; k < ids.size(); k++) {
+        std::copy_n(values.begin() + k * stride, stride, ordered.begin() + ids[k] * stride);
+    }
+
+    values.swap(ordered);
 }
 
 
-bool NBodySim2D::init(const std::vector<std::string>& sources, cl_GLuint opengl_vertex_buffer_id,
+bool NBodySim2D::init(const std::vector<std::string>& sources, const std::vector<cl_GLuint>& opengl_vertex_buffer_ids,
     uint32_t num_points, float attraction, float radius, float time_step, float max_pos,
     float max_vel, float max_start_vel, std::string& error_message)
 {
-    // find OpenCL platforms
-    cl_int ocl_err;
-    std::vector<cl::Platform> ocl_platforms;
-    cl::Platform::get(&ocl_platforms);
+    m_ocl_gl_interop = true;
 
-    if (ocl_platforms.empty()) {
-        error_message = "No OpenCL platforms found.";
+    if (opengl_vertex_buffer_ids.empty()) {
+        error_message = "No OpenGL vertex buffers.";
         return false;
     }
 
-    // find compatible OpenCL device and create OpenCL context
-    for (const cl::Platform& ocl_platform : ocl_platforms) {
-#ifdef _WIN32
-        cl_context_properties ocl_context_props[] = {
-            CL_GL_CONTEXT_KHR, reinterpret_cast<cl_context_properties>(wglGetCurrentContext()),
-            CL_WGL_HDC_KHR, reinterpret_cast<cl_context_properties>(wglGetCurrentDC()),
-            CL_CONTEXT_PLATFORM, reinterpret_cast<cl_context_properties>(ocl_platform()),
-            0
-        };
-#endif
-
-#ifdef __linux__
-        cl_context_properties ocl_context_props[] = {
-            CL_GL_CONTEXT_KHR, reinterpret_cast<cl_context_properties>(glXGetCurrentContext()),
-            CL_GLX_DISPLAY_KHR, reinterpret_cast<cl_context_properties>(glXGetCurrentDisplay()),
-            CL_CONTEXT_PLATFORM, reinterpret_cast<cl_context_properties>(ocl_platform()),
-            0
-        };
-#endif
+    if (!initContext(sources, error_message)) {
+        return false;
+    }
 
-        m_ocl_context = cl::Context(CL_DEVICE_TYPE_ALL, ocl_context_props, nullptr, nullptr, &ocl_err);
+    cl_int ocl_err;
+    m_ocl_buffers_gl.clear();
+    for (cl_GLuint opengl_vertex_buffer_id : opengl_vertex_buffer_ids) {
+        m_ocl_buffers_gl.push_back(cl::BufferGL(m_ocl_context, CL_MEM_READ_WRITE, opengl_vertex_buffer_id, &ocl_err));
         if (ocl_err != CL_SUCCESS) {
-            continue;
+            error_message = "Cannot create OpenCL buffer (vertices). Error: " + std::to_string(ocl_err);
+            return false;
         }
-
-        break;
     }
 
+    m_ocl_front_buffer = 0;
+    m_ocl_published_buffer = 0;
+
+    // the simulation keeps its own positions, the vertex buffers only receive copies
+    m_ocl_buffer_pos = cl::Buffer(m_ocl_context, CL_MEM_READ_WRITE, num_points * LOCATION_STRIDE * sizeof(float), nullptr, &ocl_err);
     if (ocl_err != CL_SUCCESS) {
-        error_message = "No compatible OpenCL devices found.";
+        error_message = "Cannot create OpenCL buffer (positions). Error: " + std::to_string(ocl_err);
         return false;
     }
 
-    // compile OpenCL program
-    cl::Program ocl_program(m_ocl_context, sources, &ocl_err);
+    std::vector<cl::Memory> ogl_objects{ m_ocl_buffers_gl[m_ocl_front_buffer] };
+    ocl_err = m_ocl_cmd_queue.enqueueAcquireGLObjects(&ogl_objects, nullptr, nullptr);
     if (ocl_err != CL_SUCCESS) {
-        error_message = "Cannot create OpenCL program. Error: " + std::to_string(ocl_err);
+        error_message = "Cannot acquire OpenGL objects. Error: " + std::to_string(ocl_err);
         return false;
     }
 
-    ocl_err = ocl_program.build("-cl-std=CL1.1");
+    ocl_err = m_ocl_cmd_queue.enqueueCopyBuffer(m_ocl_buffers_gl[m_ocl_front_buffer], m_ocl_buffer_pos, 0, 0, num_points * LOCATION_STRIDE * sizeof(float), nullptr, nullptr);
     if (ocl_err != CL_SUCCESS) {
-        error_message = "OpenCL build error: " + std::to_string(ocl_err) + "\n";
-        auto build_info = ocl_program.getBuildInfo<CL_PROGRAM_BUILD_LOG>();
-        for (auto& device_log_pair : build_info) {
-            error_message += device_log_pair.second + "\n";
-        }
+        error_message = "Cannot copy OpenCL buffer (vertices->positions). Error: " + std::to_string(ocl_err);
         return false;
     }
 
-    // create OpenCL kernels
-    m_ocl_kernel_gravity_accelerations = cl::Kernel(ocl_program, "accelerations", &ocl_err);
+    ocl_err = m_ocl_cmd_queue.enqueueReleaseGLObjects(&ogl_objects, nullptr, nullptr);
     if (ocl_err != CL_SUCCESS) {
-        error_message = "Cannot create OpenCL kernel (accelerations). Error: " + std::to_string(ocl_err);
+        error_message = "Cannot release OpenGL objects. Error: " + std::to_string(ocl_err);
         return false;
     }
 
-    m_ocl_kernel_leapfrog_positions = cl::Kernel(ocl_program, "positions", &ocl_err);
+    ocl_err = m_ocl_cmd_queue.finish();
     if (ocl_err != CL_SUCCESS) {
-        error_message = "Cannot create OpenCL kernel (positions). Error: " + std::to_string(ocl_err);
+        error_message = "Cannot execute OpenCL finish. Error: " + std::to_string(ocl_err);
         return false;
     }
 
-    m_ocl_kernel_leapfrog_velocities = cl::Kernel(ocl_program, "velocities", &ocl_err);
-    if (ocl_err != CL_SUCCESS) {
-        error_message = "Cannot create OpenCL kernel (velocities). Error: " + std::to_string(ocl_err);
+    return initSimulation(sources, num_points, attraction, radius, time_step, max_pos, max_vel,
+        max_start_vel, error_message);
+}
+
+
+bool NBodySim2D::initHeadless(const std::vector<std::string>& sources, const std::vector<float>& locations,
+    uint32_t num_points, float attraction, float radius, float time_step, float max_pos,
+    float max_vel, float max_start_vel, std::string& error_message)
+{
+    m_ocl_gl_interop = false;
+
+    if (locations.size() != num_points * LOCATION_STRIDE) {
+        error_message = "Number of locations does not match number of points.";
         return false;
     }
 
-    // create OpenCL buffers
-    m_ocl_buffer_pos = cl::BufferGL(m_ocl_context, CL_MEM_READ_WRITE, opengl_vertex_buffer_id, &ocl_err);
-    if (ocl_err != CL_SUCCESS) {
-        error_message = "Cannot create OpenCL buffer (positions). Error: " + std::to_string(ocl_err);
+    if (!initContext(sources, error_message)) {
         return false;
     }
 
-    std::vector<float> velocities = generateRandomLocations(num_points, max_start_vel);
-    m_ocl_buffer_vel = cl::Buffer(m_ocl_context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, velocities.size() * sizeof(float), velocities.data(), &ocl_err);
+    cl_int ocl_err;
+    m_ocl_buffer_pos = cl::Buffer(m_ocl_context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, locations.size() * sizeof(float), const_cast<float*>(locations.data()), &ocl_err);
     if (ocl_err != CL_SUCCESS) {
-        error_message = "Cannot create OpenCL buffer (velocities). Error: " + std::to_string(ocl_err);
+        error_message = "Cannot create OpenCL buffer (positions). Error: " + std::to_string(ocl_err);
         return false;
     }
 
-    m_ocl_buffer_acc = cl::Buffer(m_ocl_context, CL_MEM_READ_WRITE, num_points * sizeof(float), nullptr, &ocl_err);
-    if (ocl_err != CL_SUCCESS) {
-        error_message = "Cannot create OpenCL buffer (accelerations). Error: " + std::to_string(ocl_err);
+    return initSimulation(sources, num_points, attraction, radius, time_step, max_pos, max_vel,
+        max_start_vel, error_message);
+}
+
+
+bool NBodySim2D::initContext(const std::vector<std::string>& sources, std::string& error_message)
+{
+    // rank the OpenCL devices of every platform
+    cl_int ocl_err = CL_DEVICE_NOT_FOUND;
+    m_device_ranking = OpenCLDevices::rank(sources, m_program_cache_directory);
+
+    if (m_device_ranking.empty()) {
+        error_message = "No OpenCL devices found.";
         return false;
     }
 
-    // add arguments to "accelerations" kernel
-    ocl_err = m_ocl_kernel_gravity_accelerations.setArg<cl::BufferGL>(0, m_ocl_buffer_pos);
-    if (ocl_err != CL_SUCCESS) {
-        error_message = "Cannot add argument to OpenCL kernel (pos->accelerations). Error: " + std::to_string(ocl_err);
-        return false;
+    // create OpenCL context on the fastest compatible device, with the other devices of its platform behind it
+    // for multi-device execution
+    for (m_selected_device = 0; m_selected_device < m_device_ranking.size(); m_selected_device++) {
+        const OpenCLDeviceInfo& selected = m_device_ranking[m_selected_device];
+        std::vector<cl_context_properties> ocl_context_props;
+
+        if (m_ocl_gl_interop) {
+#ifdef _WIN32
+            ocl_context_props = {
+                CL_GL_CONTEXT_KHR, reinterpret_cast<cl_context_properties>(wglGetCurrentContext()),
+                CL_WGL_HDC_KHR, reinterpret_cast<cl_context_properties>(wglGetCurrentDC())
+            };
+#endif
+
+#ifdef __linux__
+            ocl_context_props = {
+                CL_GL_CONTEXT_KHR, reinterpret_cast<cl_context_properties>(glXGetCurrentContext()),
+                CL_GLX_DISPLAY_KHR, reinterpret_cast<cl_context_properties>(glXGetCurrentDisplay())
+            };
+#endif
+        }
+
+        ocl_context_props.push_back(CL_CONTEXT_PLATFORM);
+        ocl_context_props.push_back(reinterpret_cast<cl_context_properties>(selected.platform()));
+        ocl_context_props.push_back(0);
+
+        std::vector<cl::Device> ocl_devices{ selected.device };
+        if (m_multi_device) {
+            for (const OpenCLDeviceInfo& other : m_device_ranking) {
+                if ((other.platform() == selected.platform()) && (other.device() != selected.device())) {
+                    ocl_devices.push_back(other.device);
+                }
+            }
+        }
+
+        m_ocl_context = cl::Context(ocl_devices, ocl_context_props.data(), nullptr, nullptr, &ocl_err);
+        if ((ocl_err != CL_SUCCESS) && (ocl_devices.size() > 1)) {
+            // not every device may share the OpenGL context
+            m_ocl_context = cl::Context(selected.device, ocl_context_props.data(), nullptr, nullptr, &ocl_err);
+        }
+
+        if (ocl_err == CL_SUCCESS) {
+            break;
+        }
     }
 
-    ocl_err = m_ocl_kernel_gravity_accelerations.setArg<cl::Buffer>(1, m_ocl_buffer_acc);
     if (ocl_err != CL_SUCCESS) {
-        error_message = "Cannot add argument to OpenCL kernel (acc->accelerations). Error: " + std::to_string(ocl_err);
+        error_message = "No compatible OpenCL devices found.";
         return false;
     }
 
-    ocl_err = m_ocl_kernel_gravity_accelerations.setArg<float>(2, attraction);
+    // lets the device wait for OpenGL fences instead of the host
+    cl::Device ocl_device = m_ocl_context.getInfo<CL_CONTEXT_DEVICES>().front();
+    m_ocl_gl_event_supported = m_ocl_gl_interop &&
+        (ocl_device.getInfo<CL_DEVICE_EXTENSIONS>().find("cl_khr_gl_event") != std::string::npos);
+    m_gl_fence = nullptr;
+
+    // create OpenCL command queue, profiling gives the device time of every batch
+    m_ocl_cmd_queue = cl::CommandQueue(m_ocl_context, ocl_device, cl::QueueProperties::Profiling, &ocl_err);
     if (ocl_err != CL_SUCCESS) {
-        error_message = "Cannot add argument to OpenCL kernel (attr->accelerations). Error: " + std::to_string(ocl_err);
+        error_message = "Cannot create OpenCL command queue. Error: " + std::to_string(ocl_err);
         return false;
     }
 
-    ocl_err = m_ocl_kernel_gravity_accelerations.setArg<float>(3, radius);
+    return true;
+}
+
+
+bool NBodySim2D::initSimulation(const std::vector<std::string>& sources, uint32_t num_points, float attraction,
+    float radius, float time_step, float max_pos, float max_vel, float max_start_vel,
+    std::string& error_message)
+{
+    cl_int ocl_err;
+
+    m_ocl_sources = sources;
+    m_num_points = num_points;
+    m_attraction = attraction;
+    m_radius = radius;
+    m_time_step = time_step;
+    m_max_pos = max_pos;
+    m_max_vel = max_vel;
+
+    // half storage keeps the velocities in units of the speed limit and the accelerations in units of the change
+    // that reaches it in one step, powers of two so that the scaling is exact
+    m_vel_unit = m_half_storage ? std::exp2(std::ceil(std::log2(max_vel))) : 1.0f;
+    m_acc_unit = m_half_storage ? std::exp2(std::ceil(std::log2(max_vel / time_step))) : 1.0f;
+    m_vector_size = m_half_storage ? 2 * sizeof(cl_half) : 2 * sizeof(float);
+
+    // create OpenCL buffers
+    m_ocl_buffer_vel = cl::Buffer(m_ocl_context, CL_MEM_READ_WRITE, num_points * m_vector_size, nullptr, &ocl_err);
     if (ocl_err != CL_SUCCESS) {
-        error_message = "Cannot add argument to OpenCL kernel (rad->accelerations). Error: " + std::to_string(ocl_err);
+        error_message = "Cannot create OpenCL buffer (velocities). Error: " + std::to_string(ocl_err);
         return false;
     }
 
-    // add arguments to "positions" kernel
-    ocl_err = m_ocl_kernel_leapfrog_positions.setArg<cl::BufferGL>(0, m_ocl_buffer_pos);
+    ocl_err = enqueueWriteVectors(m_ocl_buffer_vel, generateRandomLocations(num_points, max_start_vel), m_vel_unit, nullptr);
     if (ocl_err != CL_SUCCESS) {
-        error_message = "Cannot add argument to OpenCL kernel (pos->positions). Error: " + std::to_string(ocl_err);
+        error_message = "Cannot write OpenCL buffer (velocities). Error: " + std::to_string(ocl_err);
         return false;
     }
 
-    ocl_err = m_ocl_kernel_leapfrog_positions.setArg<cl::Buffer>(1, m_ocl_buffer_vel);
+    m_ocl_buffer_acc = cl::Buffer(m_ocl_context, CL_MEM_READ_WRITE, num_points * m_vector_size, nullptr, &ocl_err);
     if (ocl_err != CL_SUCCESS) {
-        error_message = "Cannot add argument to OpenCL kernel (vel->positions). Error: " + std::to_string(ocl_err);
+        error_message = "Cannot create OpenCL buffer (accelerations). Error: " + std::to_string(ocl_err);
         return false;
     }
 
-    ocl_err = m_ocl_kernel_leapfrog_positions.setArg<cl::Buffer>(2, m_ocl_buffer_acc);
-    if (ocl_err != CL_SUCCESS) {
-        error_message = "Cannot add argument to OpenCL kernel (acc->positions). Error: " + std::to_string(ocl_err);
-        return false;
+    // the reordering gathers into scratch buffers and copies back, so the kernels keep their arguments
+    m_steps_since_reorder = 0;
+    m_ocl_buffer_ids = cl::Buffer();
+    if (m_reorder_interval > 0) {
+        std::vector<cl_uint> ids(num_points);
+        for (uint32_t k = 0; k < num_points; k++) {
+            ids[k] = k;
+        }
+
+        m_ocl_buffer_ids = cl::Buffer(m_ocl_context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, num_points * sizeof(cl_uint), ids.data(), &ocl_err);
+        if (ocl_err != CL_SUCCESS) {
+            error_message = "Cannot create OpenCL buffer (ids). Error: " + std::to_string(ocl_err);
+            return false;
+        }
+
+        m_ocl_buffer_reorder_ids = cl::Buffer(m_ocl_context, CL_MEM_READ_WRITE, num_points * sizeof(cl_uint), nullptr, &ocl_err);
+        if (ocl_err != CL_SUCCESS) {
+            error_message = "Cannot create OpenCL buffer (reorder ids). Error: " + std::to_string(ocl_err);
+            return false;
+        }
+
+        m_ocl_buffer_reorder_pos = cl::Buffer(m_ocl_context, CL_MEM_READ_WRITE, num_points * LOCATION_STRIDE * sizeof(float), nullptr, &ocl_err);
+        if (ocl_err != CL_SUCCESS) {
+            error_message = "Cannot create OpenCL buffer (reorder positions). Error: " + std::to_string(ocl_err);
+            return false;
+        }
+
+        m_ocl_buffer_reorder_vel = cl::Buffer(m_ocl_context, CL_MEM_READ_WRITE, num_points * m_vector_size, nullptr, &ocl_err);
+        if (ocl_err != CL_SUCCESS) {
+            error_message = "Cannot create OpenCL buffer (reorder velocities). Error: " + std::to_string(ocl_err);
+            return false;
+        }
     }
 
-    ocl_err = m_ocl_kernel_leapfrog_positions.setArg<float>(3, time_step);
-    if (ocl_err != CL_SUCCESS) {
-        error_message = "Cannot add argument to OpenCL kernel (dt->positions). Error: " + std::to_string(ocl_err);
-        return false;
+    // a stored profile replaces the default launch configuration, the autotuner replaces both
+    cl::Device ocl_device = m_ocl_context.getInfo<CL_CONTEXT_DEVICES>().front();
+    const std::string profile_path = m_profile_directory.empty() ? std::string() : LaunchProfile::filePath(m_profile_directory, ocl_device);
+    if (m_autotune) {
+        if (!autotune(error_message)) {
+            return false;
+        }
+
+        if (!profile_path.empty()) {
+            m_launch_profile.save(profile_path);
+        }
+    } else if (!profile_path.empty()) {
+        m_launch_profile.load(profile_path);
     }
 
-    ocl_err = m_ocl_kernel_leapfrog_positions.setArg<float>(4, max_pos);
-    if (ocl_err != CL_SUCCESS) {
-        error_message = "Cannot add argument to OpenCL kernel (max_pos->positions). Error: " + std::to_string(ocl_err);
+    // the tile size is baked into the specialised program, so clamp it to the devices before the build
+    for (const cl::Device& ocl_used_device : getUsedDevices()) {
+        m_launch_profile.work_group_size = std::min(m_launch_profile.work_group_size, ocl_used_device.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>());
+    }
+
+    if (!buildProgram(m_specialise_kernels, error_message) || !initKernels(error_message)) {
         return false;
     }
 
-    ocl_err = m_ocl_kernel_leapfrog_positions.setArg<float>(5, max_vel);
-    if (ocl_err != CL_SUCCESS) {
-        error_message = "Cannot add argument to OpenCL kernel (max_vel->positions). Error: " + std::to_string(ocl_err);
+    // the tiled kernel may fit fewer work-items than the device, then its tile size changes after the build
+    if (m_ocl_program_specialised && (m_accelerations_padded_size > 0) && (m_launch_profile.work_group_size != m_ocl_program_tile_size)) {
+        if (!buildProgram(false, error_message) || !initKernels(error_message)) {
+            return false;
+        }
+    }
+
+    return primeAccelerations(num_points, error_message);
+}
+
+
+bool NBodySim2D::setConstants(float attraction, float radius, float time_step, float max_pos, float max_vel,
+    std::string& error_message)
+{
+    if ((attraction == m_attraction) && (radius == m_radius) && (time_step == m_time_step) &&
+        (max_pos == m_max_pos) && (max_vel == m_max_vel)) {
+        return true;
+    }
+
+    m_attraction = attraction;
+    m_radius = radius;
+    m_time_step = time_step;
+    m_max_pos = max_pos;
+    m_max_vel = max_vel;
+
+    // the specialised program has the old constants compiled in, continue with the generic one
+    if (m_ocl_program_specialised && !buildProgram(false, error_message)) {
         return false;
     }
 
-    // add arguments to "velocities" kernel
-    ocl_err = m_ocl_kernel_leapfrog_velocities.setArg<cl::Buffer>(0, m_ocl_buffer_vel);
-    if (ocl_err != CL_SUCCESS) {
-        error_message = "Cannot add argument to OpenCL kernel (vel->velocities). Error: " + std::to_string(ocl_err);
+    if (!initKernels(error_message)) {
         return false;
     }
 
-    ocl_err = m_ocl_kernel_leapfrog_velocities.setArg<cl::Buffer>(1, m_ocl_buffer_acc);
-    if (ocl_err != CL_SUCCESS) {
-        error_message = "Cannot add argument to OpenCL kernel (acc->velocities). Error: " + std::to_string(ocl_err);
+    return primeAccelerations(m_num_points, error_message);
+}
+
+
+bool NBodySim2D::buildProgram(bool specialise, std::string& error_message)
+{
+    // %.9e keeps every bit of a float and always forms a valid floating constant
+    auto define_float = [](const char* name, float value) {
+        char define[64];
+        std::snprintf(define, sizeof(define), " -D%s=%.9ef", name, static_cast<double>(value));
+        return std::string(define);
+    };
+
+    std::string options = "-cl-std=CL1.1";
+    if (m_launch_profile.unroll > 1) {
+        options += " -DNBODY_UNROLL=" + std::to_string(m_launch_profile.unroll);
+    }
+
+    if (m_precision == Precision::Compensated) {
+        options += " -DNBODY_COMPENSATED";
+    } else if (m_precision == Precision::Double) {
+        for (const cl::Device& ocl_device : m_ocl_context.getInfo<CL_CONTEXT_DEVICES>()) {
+            if (ocl_device.getInfo<CL_DEVICE_EXTENSIONS>().find("cl_khr_fp64") == std::string::npos) {
+                error_message = "OpenCL device has no double precision (" + ocl_device.getInfo<CL_DEVICE_NAME>() + ").";
+                return false;
+            }
+        }
+
+        options += " -DNBODY_DOUBLE_SUMS";
+    }
+
+    if (m_force_law == ForceLaw::Plummer) {
+        options += " -DNBODY_FORCE_LAW_PLUMMER";
+    } else if (m_force_law == ForceLaw::Spline) {
+        options += " -DNBODY_FORCE_LAW_SPLINE";
+    }
+
+    // the units belong to the contents of the buffers, so they stay the same for programs built after init
+    if (m_half_storage) {
+        options += " -DNBODY_HALF_STORAGE" + define_float("NBODY_VEL_UNIT", m_vel_unit) + define_float("NBODY_ACC_UNIT", m_acc_unit);
+    }
+
+    if (specialise) {
+        options += define_float("NBODY_ATTRACTION", m_attraction) + define_float("NBODY_RADIUS", m_radius) +
+            define_float("NBODY_TIME_STEP", m_time_step) + define_float("NBODY_MAX_POS", m_max_pos) +
+            define_float("NBODY_MAX_VEL", m_max_vel) + " -DNBODY_NUM_POINTS=" + std::to_string(m_num_points) + "u";
+
+        if (m_launch_profile.work_group_size > 0) {
+            options += " -DNBODY_TILE_SIZE=" + std::to_string(m_launch_profile.work_group_size) + "u";
+        }
+    }
+
+    // each variant has its own options, so the binary cache keeps every one of them
+    if (!OpenCLProgramCache(m_program_cache_directory).build(m_ocl_context, m_ocl_sources, options, m_ocl_program, error_message)) {
         return false;
     }
 
-    ocl_err = m_ocl_kernel_leapfrog_velocities.setArg<float>(2, time_step);
-    if (ocl_err != CL_SUCCESS) {
-        error_message = "Cannot add argument to OpenCL kernel (dt->velocities). Error: " + std::to_string(ocl_err);
+    m_ocl_program_specialised = specialise;
+    m_ocl_program_tile_size = m_launch_profile.work_group_size;
+    return true;
+}
+
+
+bool NBodySim2D::initKernels(std::string& error_message)
+{
+    // create OpenCL kernels
+    if (!createKernel(m_ocl_program, "accelerations", m_ocl_kernel_gravity_accelerations, error_message) ||
+        !createKernel(m_ocl_program, "positions", m_ocl_kernel_leapfrog_positions, error_message) ||
+        !createKernel(m_ocl_program, "velocities", m_ocl_kernel_leapfrog_velocities, error_message)) {
         return false;
     }
 
-    ocl_err = m_ocl_kernel_leapfrog_velocities.setArg<float>(3, max_vel);
-    if (ocl_err != CL_SUCCESS) {
-        error_message = "Cannot add argument to OpenCL kernel (max_vel->velocities). Error: " + std::to_string(ocl_err);
+    // add arguments, the specialised kernels ignore the constants but still take them
+    if (!setKernelArg(m_ocl_kernel_gravity_accelerations, 0, m_ocl_buffer_pos, "pos->accelerations", error_message) ||
+        !setKernelArg(m_ocl_kernel_gravity_accelerations, 1, m_ocl_buffer_acc, "acc->accelerations", error_message) ||
+        !setKernelArg(m_ocl_kernel_gravity_accelerations, 2, m_attraction, "attr->accelerations", error_message) ||
+        !setKernelArg(m_ocl_kernel_gravity_accelerations, 3, m_radius, "rad->accelerations", error_message) ||
+        !setKernelArg(m_ocl_kernel_leapfrog_positions, 0, m_ocl_buffer_pos, "pos->positions", error_message) ||
+        !setKernelArg(m_ocl_kernel_leapfrog_positions, 1, m_ocl_buffer_vel, "vel->positions", error_message) ||
+        !setKernelArg(m_ocl_kernel_leapfrog_positions, 2, m_ocl_buffer_acc, "acc->positions", error_message) ||
+        !setKernelArg(m_ocl_kernel_leapfrog_positions, 3, m_time_step, "dt->positions", error_message) ||
+        !setKernelArg(m_ocl_kernel_leapfrog_positions, 4, m_max_pos, "max_pos->positions", error_message) ||
+        !setKernelArg(m_ocl_kernel_leapfrog_positions, 5, m_max_vel, "max_vel->positions", error_message) ||
+        !setKernelArg(m_ocl_kernel_leapfrog_positions, 6, static_cast<cl_uint>(m_num_points), "n->positions", error_message) ||
+        !setKernelArg(m_ocl_kernel_leapfrog_velocities, 0, m_ocl_buffer_vel, "vel->velocities", error_message) ||
+        !setKernelArg(m_ocl_kernel_leapfrog_velocities, 1, m_ocl_buffer_acc, "acc->velocities", error_message) ||
+        !setKernelArg(m_ocl_kernel_leapfrog_velocities, 2, m_time_step, "dt->velocities", error_message) ||
+        !setKernelArg(m_ocl_kernel_leapfrog_velocities, 3, m_max_vel, "max_vel->velocities", error_message) ||
+        !setKernelArg(m_ocl_kernel_leapfrog_velocities, 4, static_cast<cl_uint>(m_num_points), "n->velocities", error_message)) {
         return false;
     }
 
-    // create OpenCL command queue
-    m_ocl_cmd_queue = cl::CommandQueue(m_ocl_context, cl::QueueProperties::None, &ocl_err);
-    if (ocl_err != CL_SUCCESS) {
-        error_message = "Cannot create OpenCL command queue. Error: " + std::to_string(ocl_err);
+    initLeapfrogLaunch();
+
+    m_accelerations_padded_size = 0;
+    m_device_slices.clear();
+    if ((m_force_solver_settings.method == ForceSolverSettings2D::Method::Direct) && (m_launch_profile.work_group_size > 0)) {
+        if (!initTiledAccelerations(m_ocl_program, m_num_points, m_attraction, m_radius, error_message)) {
+            return false;
+        }
+    }
+
+    if ((m_force_solver_settings.method == ForceSolverSettings2D::Method::RadixTree) || (m_reorder_interval > 0)) {
+        if (!initMortonSort(m_ocl_program, m_num_points, error_message)) {
+            return false;
+        }
+    }
+
+    if ((m_reorder_interval > 0) && !initReorder(m_ocl_program, m_num_points, error_message)) {
         return false;
     }
 
+    if (m_force_solver_settings.method == ForceSolverSettings2D::Method::RadixTree) {
+        if (!initRadixTree(m_ocl_program, m_num_points, m_attraction, m_radius, error_message)) {
+            return false;
+        }
+    }
+
+    if (m_force_solver_settings.method == ForceSolverSettings2D::Method::Symmetric) {
+        if (!initSymmetricAccelerations(m_ocl_program, m_num_points, m_attraction, m_radius, error_message)) {
+            return false;
+        }
+    }
+
+    // create host side force solver, if one replaces the "accelerations" kernel
+    m_force_solver.reset();
+    if ((m_force_solver_settings.method != ForceSolverSettings2D::Method::Direct) &&
+        (m_force_solver_settings.method != ForceSolverSettings2D::Method::Symmetric) &&
+        (m_force_solver_settings.method != ForceSolverSettings2D::Method::RadixTree)) {
+        if (!m_thread_pool) {
+            m_thread_pool = std::make_unique<ThreadPool>();
+        }
+
+        if (m_force_law != ForceLaw::Cutoff) {
+            error_message = "Host force solvers have the cutoff force law only.";
+            return false;
+        }
+
+        m_force_solver = ForceSolver2D::create(m_force_solver_settings, *m_thread_pool, m_attraction, m_radius);
+        m_host_pos.resize(m_num_points * LOCATION_STRIDE);
+        m_host_acc.resize(m_num_points * 2);
+        m_host_pos_x.resize(m_num_points);
+        m_host_pos_y.resize(m_num_points);
+        m_host_mass.resize(m_num_points);
+    }
+
     return true;
 }
 
 
-bool NBodySim2D::updateLocations(uint32_t num_points, std::string& error_message)
+void NBodySim2D::initLeapfrogLaunch()
+{
+    cl::Device ocl_device = m_ocl_context.getInfo<CL_CONTEXT_DEVICES>().front();
+    size_t& group_size = m_launch_profile.leapfrog_work_group_size;
+    if (group_size > 0) {
+        group_size = std::min({ group_size,
+            m_ocl_kernel_leapfrog_positions.getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(ocl_device),
+            m_ocl_kernel_leapfrog_velocities.getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(ocl_device) });
+    }
+
+    m_leapfrog_padded_size = (group_size > 0) ? (m_num_points + group_size - 1) / group_size * group_size : m_num_points;
+}
+
+
+bool NBodySim2D::autotune(std::string& error_message)
 {
-    std::vector<cl::Memory> ogl_objects{ m_ocl_buffer_pos };
-    cl_int ocl_err = m_ocl_cmd_queue.enqueueAcquireGLObjects(&ogl_objects, nullptr, nullptr);
+    // the leapfrog kernels move the points, keep a copy of the state to restore afterwards
+    cl_int ocl_err;
+    const size_t pos_size = m_num_points * LOCATION_STRIDE * sizeof(float);
+    const size_t vel_size = m_num_points * m_vector_size;
+    cl::Buffer ocl_buffer_saved_pos(m_ocl_context, CL_MEM_READ_WRITE, pos_size, nullptr, &ocl_err);
     if (ocl_err != CL_SUCCESS) {
-        error_message = "Cannot acquire OpenGL objects. Error: " + std::to_string(ocl_err);
+        error_message = "Cannot create OpenCL buffer (saved positions). Error: " + std::to_string(ocl_err);
         return false;
     }
 
-    ocl_err = m_ocl_cmd_queue.enqueueNDRangeKernel(m_ocl_kernel_gravity_accelerations, cl::NDRange(0), cl::NDRange(num_points), cl::NullRange, nullptr, nullptr);
+    cl::Buffer ocl_buffer_saved_vel(m_ocl_context, CL_MEM_READ_WRITE, vel_size, nullptr, &ocl_err);
     if (ocl_err != CL_SUCCESS) {
-        error_message = "Cannot run OpenCL kernel (accelerations). Error: " + std::to_string(ocl_err);
+        error_message = "Cannot create OpenCL buffer (saved velocities). Error: " + std::to_string(ocl_err);
         return false;
     }
 
-    ocl_err = m_ocl_cmd_queue.enqueueNDRangeKernel(m_ocl_kernel_leapfrog_positions, cl::NDRange(0), cl::NDRange(num_points), cl::NullRange, nullptr, nullptr);
-    if (ocl_err != CL_SUCCESS) {
-        error_message = "Cannot run OpenCL kernel (positions). Error: " + std::to_string(ocl_err);
+    if ((m_ocl_cmd_queue.enqueueCopyBuffer(m_ocl_buffer_pos, ocl_buffer_saved_pos, 0, 0, pos_size) != CL_SUCCESS) ||
+        (m_ocl_cmd_queue.enqueueCopyBuffer(m_ocl_buffer_vel, ocl_buffer_saved_vel, 0, 0, vel_size) != CL_SUCCESS)) {
+        error_message = "Cannot copy OpenCL buffers (state->saved state).";
         return false;
     }
 
-    ocl_err = m_ocl_cmd_queue.enqueueNDRangeKernel(m_ocl_kernel_gravity_accelerations, cl::NDRange(0), cl::NDRange(num_points), cl::NullRange, nullptr, nullptr);
-    if (ocl_err != CL_SUCCESS) {
-        error_message = "Cannot run OpenCL kernel (accelerations). Error: " + std::to_string(ocl_err);
+    // the candidates are built from source, they would only fill the binary cache
+    const std::string program_cache_directory = m_program_cache_directory;
+    m_program_cache_directory.clear();
+
+    cl::Device ocl_device = m_ocl_context.getInfo<CL_CONTEXT_DEVICES>().front();
+    const size_t max_group_size = std::min(MAX_TUNING_GROUP_SIZE, ocl_device.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>());
+    std::vector<size_t> group_sizes{ 0 };
+    for (size_t group_size = MIN_TUNING_GROUP_SIZE; group_size <= max_group_size; group_size *= 2) {
+        group_sizes.push_back(group_size);
+    }
+
+    // tile size and unroll factor of the force kernel, which only the direct method runs
+    LaunchProfile best_profile = m_launch_profile;
+    if (m_force_solver_settings.method == ForceSolverSettings2D::Method::Direct) {
+        double best_time = std::numeric_limits<double>::infinity();
+        for (size_t group_size : group_sizes) {
+            for (size_t unroll = 1; unroll <= MAX_TUNING_UNROLL; unroll *= 2) {
+                m_launch_profile.work_group_size = group_size;
+                m_launch_profile.unroll = unroll;
+
+                // a candidate the driver rejects is skipped, as is one clamped to a smaller tile size
+                std::string candidate_error;
+                if (!buildProgram(m_specialise_kernels, candidate_error) || !initKernels(candidate_error) ||
+                    (m_launch_profile.work_group_size != group_size)) {
+                    continue;
+                }
+
+                double time;
+                const bool tiled = (m_accelerations_padded_size > 0);
+                if (!timeKernel(tiled ? m_ocl_kernel_gravity_accelerations_tiled : m_ocl_kernel_gravity_accelerations,
+                    tiled ? m_accelerations_padded_size : m_num_points, group_size, time, error_message)) {
+                    return false;
+                }
+
+                if (time < best_time) {
+                    best_time = time;
+                    best_profile.work_group_size = group_size;
+                    best_profile.unroll = unroll;
+                }
+            }
+        }
+    }
+
+    // work-group size of the leapfrog kernels, which does not need a rebuild
+    m_launch_profile = best_profile;
+    if (!buildProgram(m_specialise_kernels, error_message) || !initKernels(error_message)) {
         return false;
     }
 
-    ocl_err = m_ocl_cmd_queue.enqueueReleaseGLObjects(&ogl_objects, nullptr, nullptr);
-    if (ocl_err != CL_SUCCESS) {
-        error_message = "Cannot release OpenGL objects. Error: " + std::to_string(ocl_err);
+    double best_time = std::numeric_limits<double>::infinity();
+    for (size_t group_size : group_sizes) {
+        m_launch_profile.leapfrog_work_group_size = group_size;
+        initLeapfrogLaunch();
+        if (m_launch_profile.leapfrog_work_group_size != group_size) {
+            continue;
+        }
+
+        double positions_time;
+        double velocities_time;
+        if (!timeKernel(m_ocl_kernel_leapfrog_positions, m_leapfrog_padded_size, group_size, positions_time, error_message) ||
+            !timeKernel(m_ocl_kernel_leapfrog_velocities, m_leapfrog_padded_size, group_size, velocities_time, error_message)) {
+            return false;
+        }
+
+        if (positions_time + velocities_time < best_time) {
+            best_time = positions_time + velocities_time;
+            best_profile.leapfrog_work_group_size = group_size;
+        }
+    }
+
+    m_launch_profile = best_profile;
+    m_program_cache_directory = program_cache_directory;
+
+    if ((m_ocl_cmd_queue.enqueueCopyBuffer(ocl_buffer_saved_pos, m_ocl_buffer_pos, 0, 0, pos_size) != CL_SUCCESS) ||
+        (m_ocl_cmd_queue.enqueueCopyBuffer(ocl_buffer_saved_vel, m_ocl_buffer_vel, 0, 0, vel_size) != CL_SUCCESS)) {
+        error_message = "Cannot copy OpenCL buffers (saved state->state).";
         return false;
     }
 
-    ocl_err = m_ocl_cmd_queue.enqueueNDRangeKernel(m_ocl_kernel_leapfrog_velocities, cl::NDRange(0), cl::NDRange(num_points), cl::NullRange, nullptr, nullptr);
+    ocl_err = m_ocl_cmd_queue.finish();
     if (ocl_err != CL_SUCCESS) {
-        error_message = "Cannot run OpenCL kernel (velocities). Error: " + std::to_string(ocl_err);
+        error_message = "Cannot execute OpenCL finish. Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    return true;
+}
+
+
+bool NBodySim2D::timeKernel(cl::Kernel& ocl_kernel, size_t global_size, size_t local_size, double& time,
+    std::string& error_message)
+{
+    time = std::numeric_limits<double>::infinity();
+    const cl::NDRange ocl_local_size = (local_size > 0) ? cl::NDRange(local_size) : cl::NullRange;
+
+    for (int run = 0; run <= TUNING_RUNS; run++) {
+        cl::Event ocl_event;
+        cl_int ocl_err = m_ocl_cmd_queue.enqueueNDRangeKernel(ocl_kernel, cl::NDRange(0), cl::NDRange(global_size), ocl_local_size, nullptr, &ocl_event);
+        if (ocl_err != CL_SUCCESS) {
+            error_message = "Cannot run OpenCL kernel (autotuner). Error: " + std::to_string(ocl_err);
+            return false;
+        }
+
+        ocl_err = ocl_event.wait();
+        if (ocl_err != CL_SUCCESS) {
+            error_message = "Cannot wait for OpenCL event (autotuner). Error: " + std::to_string(ocl_err);
+            return false;
+        }
+
+        // the first run only warms up caches and clocks
+        if (run > 0) {
+            const cl_ulong start = ocl_event.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+            const cl_ulong end = ocl_event.getProfilingInfo<CL_PROFILING_COMMAND_END>();
+            time = std::min(time, static_cast<double>(end - start) * 1.0e-9);
+        }
+    }
+
+    return true;
+}
+
+
+bool NBodySim2D::primeAccelerations(uint32_t num_points, std::string& error_message)
+{
+    // not part of any batch, so left out of the profile
+    const bool profiling = m_profiler.isEnabled();
+    m_profiler.setEnabled(false);
+    const bool enqueued = enqueueAccelerations(num_points, error_message);
+    m_profiler.setEnabled(profiling);
+    if (!enqueued) {
         return false;
     }
 
-    ocl_err = cl::finish();
+    cl_int ocl_err = m_ocl_cmd_queue.finish();
     if (ocl_err != CL_SUCCESS) {
         error_message = "Cannot execute OpenCL finish. Error: " + std::to_string(ocl_err);
         return false;
@@ -274,3 +684,1073 @@ bool NBodySim2D::updateLocations(uint32_t num_points, std::string& error_message
 
     return true;
 }
+
+
+bool NBodySim2D::updateLocations(uint32_t num_points, uint32_t num_steps, std::string& error_message)
+{
+    // the queue would take any number of batches, but keeping one in flight bounds the latency
+    if (!waitForLocations(error_message)) {
+        return false;
+    }
+
+    if (num_steps == 0) {
+        return true;
+    }
+
+    // all steps go into the in-order queue back to back, nothing waits on the host
+    cl_int ocl_err;
+    const cl::NDRange leapfrog_local_size = (m_launch_profile.leapfrog_work_group_size > 0) ?
+        cl::NDRange(m_launch_profile.leapfrog_work_group_size) : cl::NullRange;
+    for (uint32_t step = 0; step < num_steps; step++) {
+        cl::Event* ocl_begin_event = (step == 0) ? &m_ocl_batch_begin_event : nullptr;
+        cl::Event* ocl_end_event = (!m_ocl_gl_interop && (step == num_steps - 1)) ? &m_ocl_batch_end_event : nullptr;
+
+        // kick-drift-kick: the first half kick uses the accelerations left from the previous step (or init)
+        ocl_err = m_ocl_cmd_queue.enqueueNDRangeKernel(m_ocl_kernel_leapfrog_positions, cl::NDRange(0), cl::NDRange(m_leapfrog_padded_size), leapfrog_local_size, nullptr, m_profiler.track("positions", ocl_begin_event));
+        if (ocl_err != CL_SUCCESS) {
+            error_message = "Cannot run OpenCL kernel (positions). Error: " + std::to_string(ocl_err);
+            return false;
+        }
+
+        // the accelerations are not moved along, the force evaluation right after replaces all of them
+        if ((m_reorder_interval > 0) && (++m_steps_since_reorder >= m_reorder_interval)) {
+            if (!enqueueReorder(num_points, error_message)) {
+                return false;
+            }
+
+            m_steps_since_reorder = 0;
+        }
+
+        if (!enqueueAccelerations(num_points, error_message)) {
+            return false;
+        }
+
+        ocl_err = m_ocl_cmd_queue.enqueueNDRangeKernel(m_ocl_kernel_leapfrog_velocities, cl::NDRange(0), cl::NDRange(m_leapfrog_padded_size), leapfrog_local_size, nullptr, m_profiler.track("velocities", ocl_end_event));
+        if (ocl_err != CL_SUCCESS) {
+            error_message = "Cannot run OpenCL kernel (velocities). Error: " + std::to_string(ocl_err);
+            return false;
+        }
+    }
+
+    if (m_ocl_gl_interop && !enqueuePublishLocations(num_points, error_message)) {
+        return false;
+    }
+
+    ocl_err = m_ocl_cmd_queue.flush();
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "Cannot execute OpenCL flush. Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    return true;
+}
+
+
+bool NBodySim2D::enqueuePublishLocations(uint32_t num_points, std::string& error_message)
+{
+    // only the back buffer is acquired, OpenGL keeps drawing from the front buffer in the meantime
+    cl_int ocl_err;
+    std::vector<cl::Event> ocl_wait_events;
+    if (m_ocl_gl_event_supported && (m_gl_fence != nullptr)) {
+        cl_event ocl_fence_event = clCreateEventFromGLsyncKHR(m_ocl_context(), m_gl_fence, &ocl_err);
+        if (ocl_err != CL_SUCCESS) {
+            error_message = "Cannot create OpenCL event from OpenGL fence. Error: " + std::to_string(ocl_err);
+            return false;
+        }
+
+        ocl_wait_events.push_back(cl::Event(ocl_fence_event));
+        m_gl_fence = nullptr;
+    }
+
+    const size_t back_buffer = (m_ocl_front_buffer + 1) % m_ocl_buffers_gl.size();
+    std::vector<cl::Memory> ogl_objects{ m_ocl_buffers_gl[back_buffer] };
+    ocl_err = m_ocl_cmd_queue.enqueueAcquireGLObjects(&ogl_objects, ocl_wait_events.empty() ? nullptr : &ocl_wait_events, m_profiler.track("acquire"));
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "Cannot acquire OpenGL objects. Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    ocl_err = m_ocl_cmd_queue.enqueueCopyBuffer(m_ocl_buffer_pos, m_ocl_buffers_gl[back_buffer], 0, 0, num_points * LOCATION_STRIDE * sizeof(float), nullptr, m_profiler.track("copy"));
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "Cannot copy OpenCL buffer (positions->vertices). Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    ocl_err = m_ocl_cmd_queue.enqueueReleaseGLObjects(&ogl_objects, nullptr, m_profiler.track("release", &m_ocl_batch_end_event));
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "Cannot release OpenGL objects. Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    // becomes the front buffer once the batch is complete
+    m_ocl_published_buffer = back_buffer;
+
+    return true;
+}
+
+
+bool NBodySim2D::initTiledAccelerations(const cl::Program& ocl_program, uint32_t num_points, float attraction,
+    float radius, std::string& error_message)
+{
+    if (!createKernel(ocl_program, "accelerations_tiled", m_ocl_kernel_gravity_accelerations_tiled, error_message)) {
+        return false;
+    }
+
+    // every device runs the same tile size
+    for (const cl::Device& ocl_device : getUsedDevices()) {
+        m_launch_profile.work_group_size = std::min(m_launch_profile.work_group_size,
+            m_ocl_kernel_gravity_accelerations_tiled.getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(ocl_device));
+    }
+
+    m_accelerations_padded_size = (num_points + m_launch_profile.work_group_size - 1) / m_launch_profile.work_group_size * m_launch_profile.work_group_size;
+
+    if (!setKernelArg(m_ocl_kernel_gravity_accelerations_tiled, 0, m_ocl_buffer_pos, "pos->accelerations_tiled", error_message) ||
+        !setKernelArg(m_ocl_kernel_gravity_accelerations_tiled, 1, m_ocl_buffer_acc, "acc->accelerations_tiled", error_message) ||
+        !setKernelArg(m_ocl_kernel_gravity_accelerations_tiled, 2, attraction, "attr->accelerations_tiled", error_message) ||
+        !setKernelArg(m_ocl_kernel_gravity_accelerations_tiled, 3, radius, "rad->accelerations_tiled", error_message) ||
+        !setKernelArg(m_ocl_kernel_gravity_accelerations_tiled, 4, static_cast<cl_uint>(num_points), "n->accelerations_tiled", error_message) ||
+        !setKernelArg(m_ocl_kernel_gravity_accelerations_tiled, 5, cl::Local(m_launch_profile.work_group_size * sizeof(cl_float4)), "tile->accelerations_tiled", error_message)) {
+        return false;
+    }
+
+    return initDeviceSlices(ocl_program, num_points, attraction, radius, error_message);
+}
+
+
+std::vector<cl::Device> NBodySim2D::getUsedDevices() const
+{
+    std::vector<cl::Device> ocl_devices = m_ocl_context.getInfo<CL_CONTEXT_DEVICES>();
+    if (!m_multi_device) {
+        ocl_devices.resize(1);
+    }
+
+    return ocl_devices;
+}
+
+
+bool NBodySim2D::initDeviceSlices(const cl::Program& ocl_program, uint32_t num_points, float attraction, float radius,
+    std::string& error_message)
+{
+    m_device_slices.clear();
+    std::vector<cl::Device> ocl_devices = getUsedDevices();
+    if (ocl_devices.size() < 2) {
+        return true;
+    }
+
+    // the main device works in place, the others on copies of the positions and accelerations
+    cl_int ocl_err;
+    m_device_slices.resize(ocl_devices.size());
+    for (size_t i = 0; i < ocl_devices.size(); i++) {
+        DeviceSlice& slice = m_device_slices[i];
+        slice.name = "accelerations (" + ocl_devices[i].getInfo<CL_DEVICE_NAME>() + ")";
+        slice.share = 1.0 / static_cast<double>(ocl_devices.size());
+
+        if (i == 0) {
+            slice.queue = m_ocl_cmd_queue;
+            slice.kernel = m_ocl_kernel_gravity_accelerations_tiled;
+            slice.pos = m_ocl_buffer_pos;
+            slice.acc = m_ocl_buffer_acc;
+            continue;
+        }
+
+        slice.queue = cl::CommandQueue(m_ocl_context, ocl_devices[i], cl::QueueProperties::Profiling, &ocl_err);
+        if (ocl_err != CL_SUCCESS) {
+            error_message = "Cannot create OpenCL command queue (" + ocl_devices[i].getInfo<CL_DEVICE_NAME>() + "). Error: " + std::to_string(ocl_err);
+            return false;
+        }
+
+        slice.pos = cl::Buffer(m_ocl_context, CL_MEM_READ_ONLY, num_points * LOCATION_STRIDE * sizeof(float), nullptr, &ocl_err);
+        if (ocl_err != CL_SUCCESS) {
+            error_message = "Cannot create OpenCL buffer (device positions). Error: " + std::to_string(ocl_err);
+            return false;
+        }
+
+        slice.acc = cl::Buffer(m_ocl_context, CL_MEM_WRITE_ONLY, num_points * m_vector_size, nullptr, &ocl_err);
+        if (ocl_err != CL_SUCCESS) {
+            error_message = "Cannot create OpenCL buffer (device accelerations). Error: " + std::to_string(ocl_err);
+            return false;
+        }
+
+        if (!createKernel(ocl_program, "accelerations_tiled", slice.kernel, error_message) ||
+            !setKernelArg(slice.kernel, 0, slice.pos, "pos->accelerations_tiled", error_message) ||
+            !setKernelArg(slice.kernel, 1, slice.acc, "acc->accelerations_tiled", error_message) ||
+            !setKernelArg(slice.kernel, 2, attraction, "attr->accelerations_tiled", error_message) ||
+            !setKernelArg(slice.kernel, 3, radius, "rad->accelerations_tiled", error_message) ||
+            !setKernelArg(slice.kernel, 4, static_cast<cl_uint>(num_points), "n->accelerations_tiled", error_message) ||
+            !setKernelArg(slice.kernel, 5, cl::Local(m_launch_profile.work_group_size * sizeof(cl_float4)), "tile->accelerations_tiled", error_message)) {
+            return false;
+        }
+    }
+
+    splitDeviceSlices(num_points);
+    return true;
+}
+
+
+void NBodySim2D::splitDeviceSlices(uint32_t num_points)
+{
+    // boundaries on whole work-groups, every device keeps at least one so that its speed stays measured
+    const size_t group_size = m_launch_profile.work_group_size;
+    const size_t num_groups = (num_points + group_size - 1) / group_size;
+    const size_t num_slices = m_device_slices.size();
+
+    // too few work-groups to go round, the main device takes them all
+    if (num_groups < num_slices) {
+        for (DeviceSlice& slice : m_device_slices) {
+            slice.begin = 0;
+            slice.end = 0;
+        }
+
+        m_device_slices.front().end = num_points;
+        return;
+    }
+
+    double total_share = 0.0;
+    size_t begin_group = 0;
+    for (size_t i = 0; i < num_slices; i++) {
+        total_share += m_device_slices[i].share;
+        const size_t later_slices = num_slices - 1 - i;
+        size_t end_group = (later_slices == 0) ? num_groups :
+            static_cast<size_t>(std::lround(total_share * static_cast<double>(num_groups)));
+        end_group = std::max(end_group, begin_group + 1);
+        end_group = std::min(end_group, (num_groups > later_slices) ? num_groups - later_slices : begin_group);
+        end_group = std::max(end_group, begin_group);
+
+        m_device_slices[i].begin = std::min(begin_group * group_size, static_cast<size_t>(num_points));
+        m_device_slices[i].end = std::min(end_group * group_size, static_cast<size_t>(num_points));
+        begin_group = end_group;
+    }
+}
+
+
+void NBodySim2D::balanceDeviceSlices(uint32_t num_points)
+{
+    // read every event before resetting any, a device without a usable measurement keeps its share
+    const size_t num_slices = m_device_slices.size();
+    std::vector<double> throughputs(num_slices, 0.0);
+    std::vector<bool> measured(num_slices, false);
+    for (size_t i = 0; i < num_slices; i++) {
+        const DeviceSlice& slice = m_device_slices[i];
+        if (slice.end <= slice.begin) {
+            measured[i] = true;
+            continue;
+        }
+
+        if (slice.event() == nullptr) {
+            continue;
+        }
+
+        cl_int ocl_err_start, ocl_err_end;
+        const cl_ulong start = slice.event.getProfilingInfo<CL_PROFILING_COMMAND_START>(&ocl_err_start);
+        const cl_ulong end = slice.event.getProfilingInfo<CL_PROFILING_COMMAND_END>(&ocl_err_end);
+        if ((ocl_err_start == CL_SUCCESS) && (ocl_err_end == CL_SUCCESS) && (end > start)) {
+            throughputs[i] = static_cast<double>(slice.end - slice.begin) / static_cast<double>(end - start);
+            measured[i] = true;
+        }
+    }
+
+    for (DeviceSlice& slice : m_device_slices) {
+        slice.event = cl::Event();
+    }
+
+    double measured_share = 0.0;
+    double total_throughput = 0.0;
+    for (size_t i = 0; i < num_slices; i++) {
+        if (measured[i]) {
+            measured_share += m_device_slices[i].share;
+            total_throughput += throughputs[i];
+        }
+    }
+
+    if (total_throughput <= 0.0) {
+        return;
+    }
+
+    // the measured devices split their shares in proportion to the points per second they managed in the last step,
+    // the floor keeps a device that fell behind in the running so that it can win work back
+    double total_share = 0.0;
+    for (size_t i = 0; i < num_slices; i++) {
+        DeviceSlice& slice = m_device_slices[i];
+        if (measured[i]) {
+            slice.share += DEVICE_SHARE_SMOOTHING * (measured_share * throughputs[i] / total_throughput - slice.share);
+        }
+
+        slice.share = std::max(slice.share, DEVICE_MIN_SHARE);
+        total_share += slice.share;
+    }
+
+    for (DeviceSlice& slice : m_device_slices) {
+        slice.share /= total_share;
+    }
+
+    splitDeviceSlices(num_points);
+}
+
+
+bool NBodySim2D::initSymmetricAccelerations(const cl::Program& ocl_program, uint32_t num_points, float attraction,
+    float radius, std::string& error_message)
+{
+    if (!createKernel(ocl_program, "accelerations_symmetric", m_ocl_kernel_gravity_accelerations_symmetric, error_message) ||
+        !createKernel(ocl_program, "accelerations_reduce", m_ocl_kernel_gravity_accelerations_reduce, error_message)) {
+        return false;
+    }
+
+    // the tiles pair up whole work-groups, the untiled setting still needs some tile size
+    cl::Device ocl_device = m_ocl_context.getInfo<CL_CONTEXT_DEVICES>().front();
+    m_symmetric_tile_size = (m_launch_profile.work_group_size > 0) ? m_launch_profile.work_group_size : SYMMETRIC_DEFAULT_TILE_SIZE;
+    m_symmetric_tile_size = std::min(m_symmetric_tile_size,
+        m_ocl_kernel_gravity_accelerations_symmetric.getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(ocl_device));
+    m_symmetric_num_tiles = (num_points + m_symmetric_tile_size - 1) / m_symmetric_tile_size;
+
+    // a band holds one value per point for each of its diagonals plus one for the row, a narrower band only takes
+    // more launches
+    // the sums keep their whole SUM_STORAGE state: a float2, or four floats' worth when compensated or double
+    const size_t sum_size = (m_precision == Precision::Float) ? 2 * sizeof(float) : 4 * sizeof(float);
+    const size_t slot_size = m_symmetric_num_tiles * m_symmetric_tile_size * sum_size;
+    const size_t max_slots = ocl_device.getInfo<CL_DEVICE_MAX_MEM_ALLOC_SIZE>() / slot_size;
+    if (max_slots < 2) {
+        error_message = "Too many points for the symmetric solver on this OpenCL device.";
+        return false;
+    }
+
+    m_symmetric_band_size = std::min({ SYMMETRIC_BAND_SIZE, m_symmetric_num_tiles, max_slots - 1 });
+
+    cl_int ocl_err;
+    m_ocl_buffer_acc_band = cl::Buffer(m_ocl_context, CL_MEM_READ_WRITE, (m_symmetric_band_size + 1) * slot_size, nullptr, &ocl_err);
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "Cannot create OpenCL buffer (band accelerations). Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    m_ocl_buffer_acc_sums = cl::Buffer(m_ocl_context, CL_MEM_READ_WRITE, num_points * sum_size, nullptr, &ocl_err);
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "Cannot create OpenCL buffer (acceleration sums). Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    // the band arguments change between the launches of a step
+    return setKernelArg(m_ocl_kernel_gravity_accelerations_symmetric, 0, m_ocl_buffer_pos, "pos->accelerations_symmetric", error_message) &&
+        setKernelArg(m_ocl_kernel_gravity_accelerations_symmetric, 1, m_ocl_buffer_acc_band, "band->accelerations_symmetric", error_message) &&
+        setKernelArg(m_ocl_kernel_gravity_accelerations_symmetric, 2, attraction, "attr->accelerations_symmetric", error_message) &&
+        setKernelArg(m_ocl_kernel_gravity_accelerations_symmetric, 3, radius, "rad->accelerations_symmetric", error_message) &&
+        setKernelArg(m_ocl_kernel_gravity_accelerations_symmetric, 4, static_cast<cl_uint>(num_points), "n->accelerations_symmetric", error_message) &&
+        setKernelArg(m_ocl_kernel_gravity_accelerations_symmetric, 5, static_cast<cl_uint>(m_symmetric_num_tiles), "num_tiles->accelerations_symmetric", error_message) &&
+        setKernelArg(m_ocl_kernel_gravity_accelerations_symmetric, 8, cl::Local(m_symmetric_tile_size * sizeof(cl_float4)), "tile_pos->accelerations_symmetric", error_message) &&
+        setKernelArg(m_ocl_kernel_gravity_accelerations_symmetric, 9, cl::Local(m_symmetric_tile_size * sum_size), "tile_acc->accelerations_symmetric", error_message) &&
+        setKernelArg(m_ocl_kernel_gravity_accelerations_reduce, 0, m_ocl_buffer_acc_band, "band->accelerations_reduce", error_message) &&
+        setKernelArg(m_ocl_kernel_gravity_accelerations_reduce, 1, m_ocl_buffer_acc_sums, "sums->accelerations_reduce", error_message) &&
+        setKernelArg(m_ocl_kernel_gravity_accelerations_reduce, 2, m_ocl_buffer_acc, "acc->accelerations_reduce", error_message) &&
+        setKernelArg(m_ocl_kernel_gravity_accelerations_reduce, 3, static_cast<cl_uint>(num_points), "n->accelerations_reduce", error_message) &&
+        setKernelArg(m_ocl_kernel_gravity_accelerations_reduce, 4, static_cast<cl_uint>(m_symmetric_num_tiles), "num_tiles->accelerations_reduce", error_message) &&
+        setKernelArg(m_ocl_kernel_gravity_accelerations_reduce, 5, static_cast<cl_uint>(m_symmetric_tile_size), "tile_size->accelerations_reduce", error_message);
+}
+
+
+bool NBodySim2D::initMortonSort(const cl::Program& ocl_program, uint32_t num_points, std::string& error_message)
+{
+    // create OpenCL kernels
+    if (!createKernel(ocl_program, "morton_keys", m_ocl_kernel_morton_keys, error_message) ||
+        !createKernel(ocl_program, "radix_histogram", m_ocl_kernel_radix_histogram, error_message) ||
+        !createKernel(ocl_program, "radix_scan", m_ocl_kernel_radix_scan, error_message) ||
+        !createKernel(ocl_program, "radix_scatter", m_ocl_kernel_radix_scatter, error_message)) {
+        return false;
+    }
+
+    // the sort works on blocks of one work-group, rounded down to a power of two the device can run
+    cl::Device ocl_device = m_ocl_context.getInfo<CL_CONTEXT_DEVICES>().front();
+    size_t max_group_size = std::min({
+        RADIX_SORT_MAX_GROUP_SIZE,
+        m_ocl_kernel_radix_scatter.getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(ocl_device),
+        m_ocl_kernel_radix_histogram.getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(ocl_device),
+        m_ocl_kernel_radix_scan.getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(ocl_device)
+    });
+
+    m_radix_sort_group_size = RADIX_SORT_DIGITS;
+    while (m_radix_sort_group_size * 2 <= max_group_size) {
+        m_radix_sort_group_size *= 2;
+    }
+
+    if (max_group_size < RADIX_SORT_DIGITS) {
+        error_message = "OpenCL device work-group size too small for the radix sort.";
+        return false;
+    }
+
+    m_radix_sort_padded_size = (num_points + m_radix_sort_group_size - 1) / m_radix_sort_group_size * m_radix_sort_group_size;
+    const size_t num_histograms = RADIX_SORT_DIGITS * (m_radix_sort_padded_size / m_radix_sort_group_size);
+
+    // create OpenCL buffers
+    cl_int ocl_err;
+    for (int i = 0; i < 2; i++) {
+        m_ocl_buffer_sort_keys[i] = cl::Buffer(m_ocl_context, CL_MEM_READ_WRITE, m_radix_sort_padded_size * sizeof(cl_uint), nullptr, &ocl_err);
+        if (ocl_err != CL_SUCCESS) {
+            error_message = "Cannot create OpenCL buffer (sort keys). Error: " + std::to_string(ocl_err);
+            return false;
+        }
+
+        m_ocl_buffer_sort_values[i] = cl::Buffer(m_ocl_context, CL_MEM_READ_WRITE, m_radix_sort_padded_size * sizeof(cl_uint), nullptr, &ocl_err);
+        if (ocl_err != CL_SUCCESS) {
+            error_message = "Cannot create OpenCL buffer (sort values). Error: " + std::to_string(ocl_err);
+            return false;
+        }
+    }
+
+    m_ocl_buffer_sort_histograms = cl::Buffer(m_ocl_context, CL_MEM_READ_WRITE, num_histograms * sizeof(cl_uint), nullptr, &ocl_err);
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "Cannot create OpenCL buffer (sort histograms). Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    // add the arguments that do not change between steps
+    const cl::LocalSpaceArg local_uints = cl::Local(m_radix_sort_group_size * sizeof(cl_uint));
+
+    return setKernelArg(m_ocl_kernel_morton_keys, 0, m_ocl_buffer_pos, "pos->morton_keys", error_message) &&
+        setKernelArg(m_ocl_kernel_morton_keys, 1, m_ocl_buffer_sort_keys[0], "keys->morton_keys", error_message) &&
+        setKernelArg(m_ocl_kernel_morton_keys, 2, m_ocl_buffer_sort_values[0], "values->morton_keys", error_message) &&
+        setKernelArg(m_ocl_kernel_morton_keys, 3, m_max_pos, "max_pos->morton_keys", error_message) &&
+        setKernelArg(m_ocl_kernel_morton_keys, 4, static_cast<cl_uint>(num_points), "n->morton_keys", error_message) &&
+        setKernelArg(m_ocl_kernel_radix_histogram, 1, m_ocl_buffer_sort_histograms, "histograms->radix_histogram", error_message) &&
+        setKernelArg(m_ocl_kernel_radix_histogram, 3, local_uints, "counts->radix_histogram", error_message) &&
+        setKernelArg(m_ocl_kernel_radix_scan, 0, m_ocl_buffer_sort_histograms, "histograms->radix_scan", error_message) &&
+        setKernelArg(m_ocl_kernel_radix_scan, 1, static_cast<cl_uint>(num_histograms), "count->radix_scan", error_message) &&
+        setKernelArg(m_ocl_kernel_radix_scan, 2, local_uints, "sums->radix_scan", error_message) &&
+        setKernelArg(m_ocl_kernel_radix_scatter, 4, m_ocl_buffer_sort_histograms, "histograms->radix_scatter", error_message) &&
+        setKernelArg(m_ocl_kernel_radix_scatter, 6, local_uints, "flags->radix_scatter", error_message);
+}
+
+
+bool NBodySim2D::initReorder(const cl::Program& ocl_program, uint32_t num_points, std::string& error_message)
+{
+    if (!createKernel(ocl_program, "reorder_points", m_ocl_kernel_reorder_points, error_message)) {
+        return false;
+    }
+
+    return setKernelArg(m_ocl_kernel_reorder_points, 0, m_ocl_buffer_pos, "pos->reorder_points", error_message) &&
+        setKernelArg(m_ocl_kernel_reorder_points, 1, m_ocl_buffer_vel, "vel->reorder_points", error_message) &&
+        setKernelArg(m_ocl_kernel_reorder_points, 2, m_ocl_buffer_ids, "ids->reorder_points", error_message) &&
+        setKernelArg(m_ocl_kernel_reorder_points, 3, m_ocl_buffer_sort_values[0], "values->reorder_points", error_message) &&
+        setKernelArg(m_ocl_kernel_reorder_points, 4, m_ocl_buffer_reorder_pos, "pos_out->reorder_points", error_message) &&
+        setKernelArg(m_ocl_kernel_reorder_points, 5, m_ocl_buffer_reorder_vel, "vel_out->reorder_points", error_message) &&
+        setKernelArg(m_ocl_kernel_reorder_points, 6, m_ocl_buffer_reorder_ids, "ids_out->reorder_points", error_message) &&
+        setKernelArg(m_ocl_kernel_reorder_points, 7, static_cast<cl_uint>(num_points), "n->reorder_points", error_message);
+}
+
+
+bool NBodySim2D::initRadixTree(const cl::Program& ocl_program, uint32_t num_points, float attraction, float radius,
+    std::string& error_message)
+{
+    if (num_points < 2) {
+        error_message = "Radix tree solver needs at least two points.";
+        return false;
+    }
+
+    // create OpenCL kernels, the Morton sort is set up by initMortonSort
+    if (!createKernel(ocl_program, "radix_tree", m_ocl_kernel_radix_tree, error_message) ||
+        !createKernel(ocl_program, "radix_tree_nodes", m_ocl_kernel_radix_tree_nodes, error_message) ||
+        !createKernel(ocl_program, "radix_tree_accelerations", m_ocl_kernel_radix_tree_accelerations, error_message)) {
+        return false;
+    }
+
+    cl_int ocl_err;
+
+    m_ocl_buffer_tree_children = cl::Buffer(m_ocl_context, CL_MEM_READ_WRITE, (num_points - 1) * 2 * sizeof(cl_uint), nullptr, &ocl_err);
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "Cannot create OpenCL buffer (tree children). Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    m_ocl_buffer_tree_parents = cl::Buffer(m_ocl_context, CL_MEM_READ_WRITE, (num_points * 2 - 1) * sizeof(cl_uint), nullptr, &ocl_err);
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "Cannot create OpenCL buffer (tree parents). Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    m_ocl_buffer_tree_visits = cl::Buffer(m_ocl_context, CL_MEM_READ_WRITE, (num_points - 1) * sizeof(cl_uint), nullptr, &ocl_err);
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "Cannot create OpenCL buffer (tree visits). Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    m_ocl_buffer_tree_node_mass = cl::Buffer(m_ocl_context, CL_MEM_READ_WRITE, (num_points - 1) * 4 * sizeof(float), nullptr, &ocl_err);
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "Cannot create OpenCL buffer (tree node mass). Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    m_ocl_buffer_tree_node_bounds = cl::Buffer(m_ocl_context, CL_MEM_READ_WRITE, (num_points - 1) * 4 * sizeof(float), nullptr, &ocl_err);
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "Cannot create OpenCL buffer (tree node bounds). Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    m_ocl_buffer_tree_sorted_pos = cl::Buffer(m_ocl_context, CL_MEM_READ_WRITE, num_points * LOCATION_STRIDE * sizeof(float), nullptr, &ocl_err);
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "Cannot create OpenCL buffer (tree sorted positions). Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    // add the arguments that do not change between steps
+    return setKernelArg(m_ocl_kernel_radix_tree, 0, m_ocl_buffer_sort_keys[0], "keys->radix_tree", error_message) &&
+        setKernelArg(m_ocl_kernel_radix_tree, 1, m_ocl_buffer_tree_children, "children->radix_tree", error_message) &&
+        setKernelArg(m_ocl_kernel_radix_tree, 2, m_ocl_buffer_tree_parents, "parents->radix_tree", error_message) &&
+        setKernelArg(m_ocl_kernel_radix_tree, 3, m_ocl_buffer_tree_visits, "visits->radix_tree", error_message) &&
+        setKernelArg(m_ocl_kernel_radix_tree, 4, static_cast<cl_uint>(num_points), "n->radix_tree", error_message) &&
+        setKernelArg(m_ocl_kernel_radix_tree_nodes, 0, m_ocl_buffer_pos, "pos->radix_tree_nodes", error_message) &&
+        setKernelArg(m_ocl_kernel_radix_tree_nodes, 1, m_ocl_buffer_sort_values[0], "values->radix_tree_nodes", error_message) &&
+        setKernelArg(m_ocl_kernel_radix_tree_nodes, 2, m_ocl_buffer_tree_children, "children->radix_tree_nodes", error_message) &&
+        setKernelArg(m_ocl_kernel_radix_tree_nodes, 3, m_ocl_buffer_tree_parents, "parents->radix_tree_nodes", error_message) &&
+        setKernelArg(m_ocl_kernel_radix_tree_nodes, 4, m_ocl_buffer_tree_visits, "visits->radix_tree_nodes", error_message) &&
+        setKernelArg(m_ocl_kernel_radix_tree_nodes, 5, m_ocl_buffer_tree_node_mass, "node_mass->radix_tree_nodes", error_message) &&
+        setKernelArg(m_ocl_kernel_radix_tree_nodes, 6, m_ocl_buffer_tree_node_bounds, "node_bounds->radix_tree_nodes", error_message) &&
+        setKernelArg(m_ocl_kernel_radix_tree_nodes, 7, m_ocl_buffer_tree_sorted_pos, "sorted_pos->radix_tree_nodes", error_message) &&
+        setKernelArg(m_ocl_kernel_radix_tree_nodes, 8, m_force_solver_settings.barnes_hut_theta, "theta->radix_tree_nodes", error_message) &&
+        setKernelArg(m_ocl_kernel_radix_tree_nodes, 9, static_cast<cl_uint>(num_points), "n->radix_tree_nodes", error_message) &&
+        setKernelArg(m_ocl_kernel_radix_tree_accelerations, 0, m_ocl_buffer_tree_sorted_pos, "sorted_pos->radix_tree_accelerations", error_message) &&
+        setKernelArg(m_ocl_kernel_radix_tree_accelerations, 1, m_ocl_buffer_sort_values[0], "values->radix_tree_accelerations", error_message) &&
+        setKernelArg(m_ocl_kernel_radix_tree_accelerations, 2, m_ocl_buffer_tree_children, "children->radix_tree_accelerations", error_message) &&
+        setKernelArg(m_ocl_kernel_radix_tree_accelerations, 3, m_ocl_buffer_tree_node_mass, "node_mass->radix_tree_accelerations", error_message) &&
+        setKernelArg(m_ocl_kernel_radix_tree_accelerations, 4, m_ocl_buffer_acc, "acc->radix_tree_accelerations", error_message) &&
+        setKernelArg(m_ocl_kernel_radix_tree_accelerations, 5, attraction, "attr->radix_tree_accelerations", error_message) &&
+        setKernelArg(m_ocl_kernel_radix_tree_accelerations, 6, radius, "rad->radix_tree_accelerations", error_message) &&
+        setKernelArg(m_ocl_kernel_radix_tree_accelerations, 7, static_cast<cl_uint>(num_points), "n->radix_tree_accelerations", error_message);
+}
+
+
+bool NBodySim2D::enqueueAccelerations(uint32_t num_points, std::string& error_message)
+{
+    if (m_force_solver_settings.method == ForceSolverSettings2D::Method::RadixTree) {
+        return enqueueRadixTreeAccelerations(num_points, error_message);
+    }
+
+    if (m_force_solver_settings.method == ForceSolverSettings2D::Method::Symmetric) {
+        return enqueueSymmetricAccelerations(error_message);
+    }
+
+    if ((m_accelerations_padded_size > 0) && !m_device_slices.empty()) {
+        return enqueueDeviceSliceAccelerations(error_message);
+    }
+
+    cl_int ocl_err;
+    if (m_accelerations_padded_size > 0) {
+        ocl_err = m_ocl_cmd_queue.enqueueNDRangeKernel(m_ocl_kernel_gravity_accelerations_tiled, cl::NDRange(0), cl::NDRange(m_accelerations_padded_size), cl::NDRange(m_launch_profile.work_group_size), nullptr, m_profiler.track("accelerations"));
+        if (ocl_err != CL_SUCCESS) {
+            error_message = "Cannot run OpenCL kernel (accelerations_tiled). Error: " + std::to_string(ocl_err);
+            return false;
+        }
+
+        return true;
+    }
+
+    if (!m_force_solver) {
+        ocl_err = m_ocl_cmd_queue.enqueueNDRangeKernel(m_ocl_kernel_gravity_accelerations, cl::NDRange(0), cl::NDRange(num_points), cl::NullRange, nullptr, m_profiler.track("accelerations"));
+        if (ocl_err != CL_SUCCESS) {
+            error_message = "Cannot run OpenCL kernel (accelerations). Error: " + std::to_string(ocl_err);
+            return false;
+        }
+
+        return true;
+    }
+
+    // host side force solver: positions make a round trip through host memory
+    ocl_err = m_ocl_cmd_queue.enqueueReadBuffer(m_ocl_buffer_pos, CL_TRUE, 0, m_host_pos.size() * sizeof(float), m_host_pos.data(), nullptr, m_profiler.track("read positions"));
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "Cannot read OpenCL buffer (positions). Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < num_points; i++) {
+        m_host_pos_x[i] = m_host_pos[i * LOCATION_STRIDE];
+        m_host_pos_y[i] = m_host_pos[i * LOCATION_STRIDE + 1];
+        m_host_mass[i] = m_host_pos[i * LOCATION_STRIDE + 2];
+    }
+
+    m_force_solver->computeAccelerations(m_host_pos_x, m_host_pos_y, m_host_mass, m_host_acc_x, m_host_acc_y);
+
+    for (uint32_t i = 0; i < num_points; i++) {
+        m_host_acc[i * 2] = m_host_acc_x[i];
+        m_host_acc[i * 2 + 1] = m_host_acc_y[i];
+    }
+
+    ocl_err = enqueueWriteVectors(m_ocl_buffer_acc, m_host_acc, m_acc_unit, m_profiler.track("write accelerations"));
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "Cannot write OpenCL buffer (accelerations). Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    return true;
+}
+
+
+bool NBodySim2D::enqueueDeviceSliceAccelerations(std::string& error_message)
+{
+    // the other devices start once the main queue has finished the positions
+    cl_int ocl_err;
+    std::vector<cl::Event> ocl_pos_events(1);
+    ocl_err = m_ocl_cmd_queue.enqueueMarker(&ocl_pos_events.front());
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "Cannot enqueue OpenCL marker (positions). Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    const size_t group_size = m_launch_profile.work_group_size;
+    for (size_t i = 0; i < m_device_slices.size(); i++) {
+        DeviceSlice& slice = m_device_slices[i];
+        if (slice.end <= slice.begin) {
+            continue;
+        }
+
+        if (i > 0) {
+            ocl_err = slice.queue.enqueueCopyBuffer(m_ocl_buffer_pos, slice.pos, 0, 0, m_num_points * LOCATION_STRIDE * sizeof(float), &ocl_pos_events, nullptr);
+            if (ocl_err != CL_SUCCESS) {
+                error_message = "Cannot copy OpenCL buffer (positions->device positions). Error: " + std::to_string(ocl_err);
+                return false;
+            }
+        }
+
+        cl::Event* ocl_event = m_profiler.track(slice.name.c_str());
+        if (ocl_event == nullptr) {
+            ocl_event = &slice.event;
+        }
+
+        const size_t global_size = (slice.end - slice.begin + group_size - 1) / group_size * group_size;
+        ocl_err = slice.queue.enqueueNDRangeKernel(slice.kernel, cl::NDRange(slice.begin), cl::NDRange(global_size), cl::NDRange(group_size), nullptr, ocl_event);
+        if (ocl_err != CL_SUCCESS) {
+            error_message = "Cannot run OpenCL kernel (accelerations_tiled, " + slice.name + "). Error: " + std::to_string(ocl_err);
+            return false;
+        }
+
+        slice.event = *ocl_event;
+        if ((i > 0) && (slice.queue.flush() != CL_SUCCESS)) {
+            error_message = "Cannot execute OpenCL flush (" + slice.name + ").";
+            return false;
+        }
+    }
+
+    // the slices start on whole work-groups, so no device writes past its own slice
+    for (size_t i = 1; i < m_device_slices.size(); i++) {
+        DeviceSlice& slice = m_device_slices[i];
+        if (slice.end <= slice.begin) {
+            continue;
+        }
+
+        const std::vector<cl::Event> ocl_slice_events{ slice.event };
+        ocl_err = m_ocl_cmd_queue.enqueueCopyBuffer(slice.acc, m_ocl_buffer_acc, slice.begin * m_vector_size, slice.begin * m_vector_size,
+            (slice.end - slice.begin) * m_vector_size, &ocl_slice_events, m_profiler.track("gather"));
+        if (ocl_err != CL_SUCCESS) {
+            error_message = "Cannot copy OpenCL buffer (device accelerations->accelerations). Error: " + std::to_string(ocl_err);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+bool NBodySim2D::enqueueSymmetricAccelerations(std::string& error_message)
+{
+    // one work-group per tile with a pair in the band, so only the upper triangle of the tile pairs is launched
+    for (size_t first_offset = 0; first_offset < m_symmetric_num_tiles; first_offset += m_symmetric_band_size) {
+        const cl_uint band_size = static_cast<cl_uint>(std::min(m_symmetric_band_size, m_symmetric_num_tiles - first_offset));
+        const cl_uint last_band = (first_offset + band_size >= m_symmetric_num_tiles) ? 1 : 0;
+        if (!setKernelArg(m_ocl_kernel_gravity_accelerations_symmetric, 6, static_cast<cl_uint>(first_offset), "first_offset->accelerations_symmetric", error_message) ||
+            !setKernelArg(m_ocl_kernel_gravity_accelerations_symmetric, 7, band_size, "band_size->accelerations_symmetric", error_message) ||
+            !setKernelArg(m_ocl_kernel_gravity_accelerations_reduce, 6, static_cast<cl_uint>(first_offset), "first_offset->accelerations_reduce", error_message) ||
+            !setKernelArg(m_ocl_kernel_gravity_accelerations_reduce, 7, band_size, "band_size->accelerations_reduce", error_message) ||
+            !setKernelArg(m_ocl_kernel_gravity_accelerations_reduce, 8, last_band, "last_band->accelerations_reduce", error_message)) {
+            return false;
+        }
+
+        const cl::NDRange global_size((m_symmetric_num_tiles - first_offset) * m_symmetric_tile_size);
+        cl_int ocl_err = m_ocl_cmd_queue.enqueueNDRangeKernel(m_ocl_kernel_gravity_accelerations_symmetric, cl::NDRange(0), global_size, cl::NDRange(m_symmetric_tile_size), nullptr, m_profiler.track("accelerations_symmetric"));
+        if (ocl_err != CL_SUCCESS) {
+            error_message = "Cannot run OpenCL kernel (accelerations_symmetric). Error: " + std::to_string(ocl_err);
+            return false;
+        }
+
+        ocl_err = m_ocl_cmd_queue.enqueueNDRangeKernel(m_ocl_kernel_gravity_accelerations_reduce, cl::NDRange(0), cl::NDRange(m_num_points), cl::NullRange, nullptr, m_profiler.track("accelerations_reduce"));
+        if (ocl_err != CL_SUCCESS) {
+            error_message = "Cannot run OpenCL kernel (accelerations_reduce). Error: " + std::to_string(ocl_err);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+bool NBodySim2D::enqueueMortonSort(std::string& error_message)
+{
+    const cl::NDRange group_size(m_radix_sort_group_size);
+
+    cl_int ocl_err = m_ocl_cmd_queue.enqueueNDRangeKernel(m_ocl_kernel_morton_keys, cl::NDRange(0), cl::NDRange(m_radix_sort_padded_size), group_size, nullptr, m_profiler.track("morton_keys"));
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "Cannot run OpenCL kernel (morton_keys). Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    // least significant digit first radix sort, the result ends up in the first buffer again
+    for (cl_uint shift = 0; shift < 32; shift += RADIX_SORT_BITS) {
+        const int src = (shift / RADIX_SORT_BITS) % 2;
+        const int dst = 1 - src;
+
+        if (!setKernelArg(m_ocl_kernel_radix_histogram, 0, m_ocl_buffer_sort_keys[src], "keys->radix_histogram", error_message) ||
+            !setKernelArg(m_ocl_kernel_radix_histogram, 2, shift, "shift->radix_histogram", error_message) ||
+            !setKernelArg(m_ocl_kernel_radix_scatter, 0, m_ocl_buffer_sort_keys[src], "keys_in->radix_scatter", error_message) ||
+            !setKernelArg(m_ocl_kernel_radix_scatter, 1, m_ocl_buffer_sort_values[src], "values_in->radix_scatter", error_message) ||
+            !setKernelArg(m_ocl_kernel_radix_scatter, 2, m_ocl_buffer_sort_keys[dst], "keys_out->radix_scatter", error_message) ||
+            !setKernelArg(m_ocl_kernel_radix_scatter, 3, m_ocl_buffer_sort_values[dst], "values_out->radix_scatter", error_message) ||
+            !setKernelArg(m_ocl_kernel_radix_scatter, 5, shift, "shift->radix_scatter", error_message)) {
+            return false;
+        }
+
+        ocl_err = m_ocl_cmd_queue.enqueueNDRangeKernel(m_ocl_kernel_radix_histogram, cl::NDRange(0), cl::NDRange(m_radix_sort_padded_size), group_size, nullptr, m_profiler.track("radix_histogram"));
+        if (ocl_err != CL_SUCCESS) {
+            error_message = "Cannot run OpenCL kernel (radix_histogram). Error: " + std::to_string(ocl_err);
+            return false;
+        }
+
+        ocl_err = m_ocl_cmd_queue.enqueueNDRangeKernel(m_ocl_kernel_radix_scan, cl::NDRange(0), group_size, group_size, nullptr, m_profiler.track("radix_scan"));
+        if (ocl_err != CL_SUCCESS) {
+            error_message = "Cannot run OpenCL kernel (radix_scan). Error: " + std::to_string(ocl_err);
+            return false;
+        }
+
+        ocl_err = m_ocl_cmd_queue.enqueueNDRangeKernel(m_ocl_kernel_radix_scatter, cl::NDRange(0), cl::NDRange(m_radix_sort_padded_size), group_size, nullptr, m_profiler.track("radix_scatter"));
+        if (ocl_err != CL_SUCCESS) {
+            error_message = "Cannot run OpenCL kernel (radix_scatter). Error: " + std::to_string(ocl_err);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+bool NBodySim2D::enqueueReorder(uint32_t num_points, std::string& error_message)
+{
+    if (!enqueueMortonSort(error_message)) {
+        return false;
+    }
+
+    cl_int ocl_err = m_ocl_cmd_queue.enqueueNDRangeKernel(m_ocl_kernel_reorder_points, cl::NDRange(0), cl::NDRange(num_points), cl::NullRange, nullptr, m_profiler.track("reorder_points"));
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "Cannot run OpenCL kernel (reorder_points). Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    ocl_err = m_ocl_cmd_queue.enqueueCopyBuffer(m_ocl_buffer_reorder_pos, m_ocl_buffer_pos, 0, 0, num_points * LOCATION_STRIDE * sizeof(float), nullptr, m_profiler.track("reorder_copy"));
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "Cannot copy OpenCL buffer (reorder positions). Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    ocl_err = m_ocl_cmd_queue.enqueueCopyBuffer(m_ocl_buffer_reorder_vel, m_ocl_buffer_vel, 0, 0, num_points * m_vector_size, nullptr, m_profiler.track("reorder_copy"));
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "Cannot copy OpenCL buffer (reorder velocities). Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    ocl_err = m_ocl_cmd_queue.enqueueCopyBuffer(m_ocl_buffer_reorder_ids, m_ocl_buffer_ids, 0, 0, num_points * sizeof(cl_uint), nullptr, m_profiler.track("reorder_copy"));
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "Cannot copy OpenCL buffer (reorder ids). Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    return true;
+}
+
+
+bool NBodySim2D::enqueueRadixTreeAccelerations(uint32_t num_points, std::string& error_message)
+{
+    if (!enqueueMortonSort(error_message)) {
+        return false;
+    }
+
+    cl_int ocl_err = m_ocl_cmd_queue.enqueueNDRangeKernel(m_ocl_kernel_radix_tree, cl::NDRange(0), cl::NDRange(num_points - 1), cl::NullRange, nullptr, m_profiler.track("radix_tree"));
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "Cannot run OpenCL kernel (radix_tree). Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    ocl_err = m_ocl_cmd_queue.enqueueNDRangeKernel(m_ocl_kernel_radix_tree_nodes, cl::NDRange(0), cl::NDRange(num_points), cl::NullRange, nullptr, m_profiler.track("radix_tree_nodes"));
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "Cannot run OpenCL kernel (radix_tree_nodes). Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    ocl_err = m_ocl_cmd_queue.enqueueNDRangeKernel(m_ocl_kernel_radix_tree_accelerations, cl::NDRange(0), cl::NDRange(num_points), cl::NullRange, nullptr, m_profiler.track("radix_tree_accelerations"));
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "Cannot run OpenCL kernel (radix_tree_accelerations). Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    return true;
+}
+
+
+bool NBodySim2D::readLocations(std::vector<float>& locations, std::string& error_message)
+{
+    locations.resize(m_ocl_buffer_pos.getInfo<CL_MEM_SIZE>() / sizeof(float));
+    cl_int ocl_err = m_ocl_cmd_queue.enqueueReadBuffer(m_ocl_buffer_pos, CL_TRUE, 0, locations.size() * sizeof(float), locations.data(), nullptr, nullptr);
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "Cannot read OpenCL buffer (positions). Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    if (m_ocl_buffer_ids() != nullptr) {
+        std::vector<uint32_t> ids;
+        if (!readPointIds(ids, error_message)) {
+            return false;
+        }
+
+        restoreIdOrder(ids, LOCATION_STRIDE, locations);
+    }
+
+    return true;
+}
+
+
+bool NBodySim2D::readPointIds(std::vector<uint32_t>& ids, std::string& error_message)
+{
+    ids.resize(m_num_points);
+    if (m_ocl_buffer_ids() == nullptr) {
+        for (uint32_t k = 0; k < m_num_points; k++) {
+            ids[k] = k;
+        }
+
+        return true;
+    }
+
+    cl_int ocl_err = m_ocl_cmd_queue.enqueueReadBuffer(m_ocl_buffer_ids, CL_TRUE, 0, ids.size() * sizeof(cl_uint), ids.data(), nullptr, nullptr);
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "Cannot read OpenCL buffer (ids). Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    return true;
+}
+
+
+cl_int NBodySim2D::enqueueWriteVectors(const cl::Buffer& ocl_buffer, const std::vector<float>& values, float unit, cl::Event* ocl_event)
+{
+    if (!m_half_storage) {
+        return m_ocl_cmd_queue.enqueueWriteBuffer(ocl_buffer, CL_TRUE, 0, values.size() * sizeof(float), values.data(), nullptr, ocl_event);
+    }
+
+    std::vector<cl_half> halves(values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+        halves[i] = cl_half_from_float(std::clamp(values[i] / unit, -HALF_STORAGE_MAX, HALF_STORAGE_MAX), CL_HALF_RTE);
+    }
+
+    return m_ocl_cmd_queue.enqueueWriteBuffer(ocl_buffer, CL_TRUE, 0, halves.size() * sizeof(cl_half), halves.data(), nullptr, ocl_event);
+}
+
+
+cl_int NBodySim2D::enqueueReadVectors(const cl::Buffer& ocl_buffer, std::vector<float>& values, float unit)
+{
+    values.resize(m_num_points * 2);
+    if (!m_half_storage) {
+        return m_ocl_cmd_queue.enqueueReadBuffer(ocl_buffer, CL_TRUE, 0, values.size() * sizeof(float), values.data(), nullptr, nullptr);
+    }
+
+    std::vector<cl_half> halves(values.size());
+    cl_int ocl_err = m_ocl_cmd_queue.enqueueReadBuffer(ocl_buffer, CL_TRUE, 0, halves.size() * sizeof(cl_half), halves.data(), nullptr, nullptr);
+    for (size_t i = 0; i < values.size(); i++) {
+        values[i] = cl_half_to_float(halves[i]) * unit;
+    }
+
+    return ocl_err;
+}
+
+
+bool NBodySim2D::readAccelerations(std::vector<float>& accelerations, std::string& error_message)
+{
+    // the queue is in order, so the blocking read comes after the batch in flight
+    cl_int ocl_err = enqueueReadVectors(m_ocl_buffer_acc, accelerations, m_acc_unit);
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "Cannot read OpenCL buffer (accelerations). Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    if (m_ocl_buffer_ids() != nullptr) {
+        std::vector<uint32_t> ids;
+        if (!readPointIds(ids, error_message)) {
+            return false;
+        }
+
+        restoreIdOrder(ids, 2, accelerations);
+    }
+
+    return true;
+}
+
+
+bool NBodySim2D::waitForLocations(std::string& error_message)
+{
+    if (m_ocl_batch_end_event() == nullptr) {
+        return true;
+    }
+
+    cl_int ocl_err = m_ocl_batch_end_event.wait();
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "Cannot wait for OpenCL event. Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    cl_int ocl_err_begin, ocl_err_end;
+    cl_ulong begin_time = m_ocl_batch_begin_event.getProfilingInfo<CL_PROFILING_COMMAND_START>(&ocl_err_begin);
+    cl_ulong end_time = m_ocl_batch_end_event.getProfilingInfo<CL_PROFILING_COMMAND_END>(&ocl_err_end);
+    if ((ocl_err_begin == CL_SUCCESS) && (ocl_err_end == CL_SUCCESS) && (end_time > begin_time)) {
+        m_last_batch_time = static_cast<double>(end_time - begin_time) * 1.0e-9;
+    }
+
+    m_profiler.collect();
+    if (!m_device_slices.empty()) {
+        balanceDeviceSlices(m_num_points);
+    }
+
+    m_ocl_batch_begin_event = cl::Event();
+    m_ocl_batch_end_event = cl::Event();
+    m_ocl_front_buffer = m_ocl_published_buffer;
+    return true;
+}
+
+
+double NBodySim2D::getLastBatchTime() const
+{
+    return m_last_batch_time;
+}
+
+
+bool NBodySim2D::sharesVertexBuffer() const
+{
+    return m_ocl_gl_interop;
+}
+
+
+void NBodySim2D::setWorkGroupSize(size_t work_group_size)
+{
+    m_launch_profile.work_group_size = work_group_size;
+}
+
+
+size_t NBodySim2D::getWorkGroupSize() const
+{
+    return m_launch_profile.work_group_size;
+}
+
+
+void NBodySim2D::setProfileDirectory(const std::string& directory)
+{
+    m_profile_directory = directory;
+}
+
+
+void NBodySim2D::setAutotune(bool autotune)
+{
+    m_autotune = autotune;
+}
+
+
+const LaunchProfile& NBodySim2D::getLaunchProfile() const
+{
+    return m_launch_profile;
+}
+
+
+void NBodySim2D::setMultiDevice(bool multi_device)
+{
+    m_multi_device = multi_device;
+}
+
+
+size_t NBodySim2D::getNumDevices() const
+{
+    return std::max<size_t>(m_device_slices.size(), 1);
+}
+
+
+const std::vector<OpenCLDeviceInfo>& NBodySim2D::getDeviceRanking() const
+{
+    return m_device_ranking;
+}
+
+
+size_t NBodySim2D::getSelectedDevice() const
+{
+    return m_selected_device;
+}
+
+
+void NBodySim2D::setProfiling(bool profiling)
+{
+    m_profiler.setEnabled(profiling);
+    if (!profiling) {
+        m_profiler.clear();
+    }
+}
+
+
+const std::vector<CommandProfiler::CommandStats>& NBodySim2D::getProfilingStats() const
+{
+    return m_profiler.getStats();
+}
+
+
+size_t NBodySim2D::getFrontBufferIndex() const
+{
+    return m_ocl_front_buffer;
+}
+
+
+void NBodySim2D::setSpecialiseKernels(bool specialise)
+{
+    m_specialise_kernels = specialise;
+}
+
+
+void NBodySim2D::setHalfStorage(bool half_storage)
+{
+    m_half_storage = half_storage;
+}
+
+
+void NBodySim2D::setReorderInterval(uint32_t reorder_interval)
+{
+    m_reorder_interval = reorder_interval;
+}
+
+
+void NBodySim2D::setPrecision(Precision precision)
+{
+    m_precision = precision;
+}
+
+
+NBodySim2D::Precision NBodySim2D::getPrecision() const
+{
+    return m_precision;
+}
+
+
+void NBodySim2D::setForceLaw(ForceLaw force_law)
+{
+    m_force_law = force_law;
+}
+
+
+NBodySim2D::ForceLaw NBodySim2D::getForceLaw() const
+{
+    return m_force_law;
+}
+
+
+void NBodySim2D::setProgramCacheDirectory(const std::string& directory)
+{
+    m_program_cache_directory = directory;
+}
+
+
+void NBodySim2D::setGlFence(cl_GLsync fence)
+{
+    m_gl_fence = fence;
+}
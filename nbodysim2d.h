@@ -1,32 +1,278 @@
 #ifndef NBODYSIM2D_H
 #define NBODYSIM2D_H
 
-#include <string>
-#include <vector>
+#include "commandprofiler.h"
+#include "launchprofile.h"
+#include "nbodybackend2d.h"
+#include "opencldevices.h"
 
 #define CL_HPP_MINIMUM_OPENCL_VERSION 110
 #define CL_HPP_TARGET_OPENCL_VERSION 110
 #include <CL/cl2.hpp>
 
-class NBodySim2D {
+class NBodySim2D : public NBodyBackend2D {
 public:
-    static std::vector<float> generateRandomLocations(uint32_t num_points, float max_value);
+    // How the force kernels sum the contributions to a point. Partial sums keep their full state, also where the
+    // symmetric kernel passes them through memory, and become a float once at the end.
+    enum class Precision {
+        Float, // plain float additions
+        Compensated, // Kahan summation in float
+        Double // double accumulators, needs cl_khr_fp64 on every device
+    };
 
-    bool init(const std::vector<std::string>& sources, cl_GLuint opengl_vertex_buffer_id,
+    // Force between two points, the radius of the run sets its scale. The OpenCL force kernels evaluate each
+    // without branches, the host solvers have Cutoff only.
+    enum class ForceLaw {
+        Cutoff, // Newtonian, no force closer than the radius
+        Plummer, // softened by the radius as the Plummer length
+        Spline // cubic spline softening, Newtonian beyond the radius
+    };
+
+    // The positions and masses are read from the first vertex buffer, in the LOCATION_STRIDE layout. Every batch is
+    // copied into the vertex buffer after the front one, which becomes the front buffer once the batch is complete.
+    bool init(const std::vector<std::string>& sources, const std::vector<cl_GLuint>& opengl_vertex_buffer_ids,
+        uint32_t num_points, float attraction, float radius, float time_step, float max_pos,
+        float max_vel, float max_start_vel, std::string& error_message);
+
+    // Headless variant of init: no OpenGL context is needed, positions live in a plain OpenCL buffer.
+    bool initHeadless(const std::vector<std::string>& sources, const std::vector<float>& locations,
         uint32_t num_points, float attraction, float radius, float time_step, float max_pos,
         float max_vel, float max_start_vel, std::string& error_message);
 
-    bool updateLocations(uint32_t num_points, std::string& error_message);
+    bool updateLocations(uint32_t num_points, uint32_t num_steps, std::string& error_message) override;
+    bool readLocations(std::vector<float>& locations, std::string& error_message) override;
+    bool waitForLocations(std::string& error_message) override;
+    double getLastBatchTime() const override;
+
+    // Accelerations of the current positions, two floats per point, after the batch in flight.
+    bool readAccelerations(std::vector<float>& accelerations, std::string& error_message);
+    bool sharesVertexBuffer() const override;
+
+    // Changes the physical constants of a running simulation. A specialised program has the old ones compiled in,
+    // so the simulation continues with the generic kernels that read them from their arguments.
+    bool setConstants(float attraction, float radius, float time_step, float max_pos, float max_vel,
+        std::string& error_message);
+
+    // Compile the constants, the number of points and the tile size into the kernels (default). Takes effect on
+    // the next init.
+    void setSpecialiseKernels(bool specialise);
+
+    // Keeps the velocities and accelerations as halves, two bytes per value instead of four. The arithmetic stays
+    // float, the stored values lose precision and are clamped to the range of half. Takes effect on the next init.
+    void setHalfStorage(bool half_storage);
+
+    // Sorts the points along the Z-order curve on the device every reorder_interval steps, so that points near in
+    // space are near in memory. 0 never sorts (default). Takes effect on the next init.
+    void setReorderInterval(uint32_t reorder_interval);
+
+    // External id of the point in every slot of the device buffers, the identity until the first reordering.
+    // readLocations and readAccelerations already return the points in the order of their ids.
+    bool readPointIds(std::vector<uint32_t>& ids, std::string& error_message);
+
+    // Summation of the forces, Float by default. Takes effect on the next init.
+    void setPrecision(Precision precision);
+    Precision getPrecision() const;
+
+    // Cutoff by default. Takes effect on the next init.
+    void setForceLaw(ForceLaw force_law);
+    ForceLaw getForceLaw() const;
+
+    // Directory of the compiled program cache, empty compiles from source every time. Takes effect on the next init.
+    void setProgramCacheDirectory(const std::string& directory);
+
+    // Vertex buffer holding the latest complete positions, the one to draw from.
+    size_t getFrontBufferIndex() const;
+
+    // OpenGL fence placed after the last draw from the vertex buffer. With cl_khr_gl_event the next batch waits
+    // for it on the device before acquiring the buffer. Must stay valid until that batch has started.
+    void setGlFence(cl_GLsync fence);
+
+    // Work-group size of the tiled direct kernel, 0 runs the untiled kernel with the driver's choice instead.
+    // Takes effect on the next init, clamped to what the device can run. A stored launch profile replaces it.
+    void setWorkGroupSize(size_t work_group_size);
+    size_t getWorkGroupSize() const;
+
+    // Directory of the per-device launch profiles, init loads the profile of its device from there. Empty keeps
+    // the defaults.
+    void setProfileDirectory(const std::string& directory);
+
+    // Makes the next init time the candidate launch configurations on the device and keep the fastest, which is
+    // also stored as the device's profile when there is a profile directory.
+    void setAutotune(bool autotune);
+    const LaunchProfile& getLaunchProfile() const;
+
+    // Splits the direct force computation across every device of the context, in proportion to their measured
+    // speed. Needs the tiled kernel, takes effect on the next init.
+    void setMultiDevice(bool multi_device);
+    size_t getNumDevices() const;
+
+    // Every OpenCL device found by init, fastest first, and the index of the one the simulation runs on (the main
+    // device with multi-device execution).
+    const std::vector<OpenCLDeviceInfo>& getDeviceRanking() const;
+    size_t getSelectedDevice() const;
+
+    // Records the device timings of every command of the batches, off by default. The statistics are rolling
+    // averages, updated by waitForLocations.
+    void setProfiling(bool profiling);
+    const std::vector<CommandProfiler::CommandStats>& getProfilingStats() const;
 
 private:
+    // Range of points whose accelerations one device computes. The main device comes first and works on the main
+    // queue, kernel and buffers, the others on copies that are gathered into the main buffer.
+    struct DeviceSlice {
+        cl::CommandQueue queue;
+        cl::Kernel kernel;
+        cl::Buffer pos;
+        cl::Buffer acc;
+        cl::Event event; // force kernel of the last step
+        std::string name;
+        double share = 0.0; // fraction of the points
+        size_t begin = 0;
+        size_t end = 0;
+    };
+
+    static constexpr cl_uint RADIX_SORT_BITS = 4;
+    static constexpr cl_uint RADIX_SORT_DIGITS = 1 << RADIX_SORT_BITS;
+    static constexpr size_t RADIX_SORT_MAX_GROUP_SIZE = 256;
+    static constexpr size_t MIN_TUNING_GROUP_SIZE = 32;
+    static constexpr size_t MAX_TUNING_GROUP_SIZE = 1024;
+    static constexpr size_t MAX_TUNING_UNROLL = 8;
+    static constexpr size_t SYMMETRIC_DEFAULT_TILE_SIZE = 64; // used when the work-group size is 0
+    static constexpr size_t SYMMETRIC_BAND_SIZE = 16; // diagonals of tile pairs per launch of the symmetric kernel
+    static constexpr double DEVICE_SHARE_SMOOTHING = 0.25; // weight of the latest batch in the device shares
+    static constexpr double DEVICE_MIN_SHARE = 0.02; // smallest share of a device, before normalisation
+    static constexpr int TUNING_RUNS = 3; // timed runs per configuration, after one warm-up run
+    static constexpr float HALF_STORAGE_MAX = 65504.0f; // largest finite half
+
+    bool m_ocl_gl_interop = false;
+    std::string m_program_cache_directory;
+    bool m_ocl_gl_event_supported = false;
+    cl_GLsync m_gl_fence = nullptr;
+    bool m_specialise_kernels = true;
+    Precision m_precision = Precision::Float;
+    ForceLaw m_force_law = ForceLaw::Cutoff;
+    bool m_half_storage = false;
+    float m_vel_unit = 1.0f; // of the stored velocities
+    float m_acc_unit = 1.0f; // of the stored accelerations
+    size_t m_vector_size = 2 * sizeof(float); // bytes per point of the velocities and accelerations
+    uint32_t m_reorder_interval = 0;
+    uint32_t m_steps_since_reorder = 0;
+    bool m_ocl_program_specialised = false;
+    size_t m_ocl_program_tile_size = 0; // tile size compiled into the specialised program
+    std::vector<std::string> m_ocl_sources;
+    cl::Program m_ocl_program;
+    uint32_t m_num_points = 0;
+    float m_attraction = 0.0f;
+    float m_radius = 0.0f;
+    float m_time_step = 0.0f;
+    float m_max_pos = 0.0f;
+    float m_max_vel = 0.0f;
+    LaunchProfile m_launch_profile;
+    std::string m_profile_directory;
+    bool m_autotune = false;
+    size_t m_leapfrog_padded_size = 0; // global size of the leapfrog kernels
+    bool m_multi_device = false;
+    std::vector<OpenCLDeviceInfo> m_device_ranking;
+    size_t m_selected_device = 0;
+    std::vector<DeviceSlice> m_device_slices; // empty on a single device
+    size_t m_accelerations_padded_size = 0; // global size of the tiled kernel
     cl::Context m_ocl_context;
     cl::CommandQueue m_ocl_cmd_queue;
     cl::Kernel m_ocl_kernel_gravity_accelerations;
+    cl::Kernel m_ocl_kernel_gravity_accelerations_tiled;
+    cl::Kernel m_ocl_kernel_gravity_accelerations_symmetric;
+    cl::Kernel m_ocl_kernel_gravity_accelerations_reduce;
     cl::Kernel m_ocl_kernel_leapfrog_positions;
     cl::Kernel m_ocl_kernel_leapfrog_velocities;
-    cl::BufferGL m_ocl_buffer_pos;
+    CommandProfiler m_profiler;
+    cl::Event m_ocl_batch_begin_event;
+    cl::Event m_ocl_batch_end_event; // release of the vertex buffer, or the last kernel without OpenGL
+    double m_last_batch_time = 0.0;
+    cl::Buffer m_ocl_buffer_pos;
+    std::vector<cl::BufferGL> m_ocl_buffers_gl; // ring of vertex buffers, used with OpenGL interop only
+    size_t m_ocl_front_buffer = 0;
+    size_t m_ocl_published_buffer = 0; // written by the batch in flight
     cl::Buffer m_ocl_buffer_vel;
     cl::Buffer m_ocl_buffer_acc;
+    cl::Buffer m_ocl_buffer_acc_band; // band_size + 1 values per point, symmetric solver only
+    cl::Buffer m_ocl_buffer_acc_sums; // per point, symmetric solver only
+    size_t m_symmetric_tile_size = 0;
+    size_t m_symmetric_num_tiles = 0;
+    size_t m_symmetric_band_size = 0;
+    cl::Kernel m_ocl_kernel_morton_keys;
+    cl::Kernel m_ocl_kernel_radix_histogram;
+    cl::Kernel m_ocl_kernel_radix_scan;
+    cl::Kernel m_ocl_kernel_radix_scatter;
+    cl::Kernel m_ocl_kernel_reorder_points;
+    cl::Kernel m_ocl_kernel_radix_tree;
+    cl::Kernel m_ocl_kernel_radix_tree_nodes;
+    cl::Kernel m_ocl_kernel_radix_tree_accelerations;
+    cl::Buffer m_ocl_buffer_sort_keys[2];
+    cl::Buffer m_ocl_buffer_sort_values[2];
+    cl::Buffer m_ocl_buffer_sort_histograms;
+    cl::Buffer m_ocl_buffer_ids; // external id of every slot, only with reordering
+    cl::Buffer m_ocl_buffer_reorder_pos;
+    cl::Buffer m_ocl_buffer_reorder_vel;
+    cl::Buffer m_ocl_buffer_reorder_ids;
+    cl::Buffer m_ocl_buffer_tree_children;
+    cl::Buffer m_ocl_buffer_tree_parents;
+    cl::Buffer m_ocl_buffer_tree_visits;
+    cl::Buffer m_ocl_buffer_tree_node_mass;
+    cl::Buffer m_ocl_buffer_tree_node_bounds;
+    cl::Buffer m_ocl_buffer_tree_sorted_pos;
+    size_t m_radix_sort_group_size = 0;
+    size_t m_radix_sort_padded_size = 0;
+    std::unique_ptr<ThreadPool> m_thread_pool;
+    std::unique_ptr<ForceSolver2D> m_force_solver;
+    std::vector<float> m_host_pos;
+    std::vector<float> m_host_acc;
+    std::vector<float> m_host_pos_x;
+    std::vector<float> m_host_pos_y;
+    std::vector<float> m_host_mass;
+    std::vector<float> m_host_acc_x;
+    std::vector<float> m_host_acc_y;
+
+    bool initContext(const std::vector<std::string>& sources, std::string& error_message);
+    bool initSimulation(const std::vector<std::string>& sources, uint32_t num_points, float attraction,
+        float radius, float time_step, float max_pos, float max_vel, float max_start_vel,
+        std::string& error_message);
+    // Builds the program from m_ocl_sources, with the constants of the run as defines if specialised.
+    bool buildProgram(bool specialise, std::string& error_message);
+    // Creates the kernels of m_ocl_program and adds their arguments, plus the host solver if one is selected.
+    bool initKernels(std::string& error_message);
+    // Computes the accelerations of the initial positions, every step then needs only one force evaluation.
+    bool primeAccelerations(uint32_t num_points, std::string& error_message);
+    bool initTiledAccelerations(const cl::Program& ocl_program, uint32_t num_points, float attraction, float radius,
+        std::string& error_message);
+    // The main device, or every device of the context with multi-device execution.
+    std::vector<cl::Device> getUsedDevices() const;
+    bool initDeviceSlices(const cl::Program& ocl_program, uint32_t num_points, float attraction, float radius,
+        std::string& error_message);
+    void splitDeviceSlices(uint32_t num_points);
+    void balanceDeviceSlices(uint32_t num_points);
+    bool initSymmetricAccelerations(const cl::Program& ocl_program, uint32_t num_points, float attraction, float radius,
+        std::string& error_message);
+    // Morton keys of the positions and their radix sort, shared by the radix tree and the reordering.
+    bool initMortonSort(const cl::Program& ocl_program, uint32_t num_points, std::string& error_message);
+    bool initReorder(const cl::Program& ocl_program, uint32_t num_points, std::string& error_message);
+    bool initRadixTree(const cl::Program& ocl_program, uint32_t num_points, float attraction, float radius,
+        std::string& error_message);
+    // Sets the global size of the leapfrog kernels for the work-group size of the launch profile.
+    void initLeapfrogLaunch();
+    bool autotune(std::string& error_message);
+    // Best device time of TUNING_RUNS launches, local_size 0 leaves the work-group size to the driver.
+    bool timeKernel(cl::Kernel& ocl_kernel, size_t global_size, size_t local_size, double& time, std::string& error_message);
+    // Blocking transfers of two floats per point to and from the velocity or acceleration storage.
+    cl_int enqueueWriteVectors(const cl::Buffer& ocl_buffer, const std::vector<float>& values, float unit, cl::Event* ocl_event);
+    cl_int enqueueReadVectors(const cl::Buffer& ocl_buffer, std::vector<float>& values, float unit);
+    bool enqueuePublishLocations(uint32_t num_points, std::string& error_message);
+    bool enqueueAccelerations(uint32_t num_points, std::string& error_message);
+    bool enqueueDeviceSliceAccelerations(std::string& error_message);
+    bool enqueueSymmetricAccelerations(std::string& error_message);
+    // Leaves the slot of every point in Z-order in the first values buffer.
+    bool enqueueMortonSort(std::string& error_message);
+    bool enqueueReorder(uint32_t num_points, std::string& error_message);
+    bool enqueueRadixTreeAccelerations(uint32_t num_points, std::string& error_message);
 };
 
 #endif // NBODYSIM2D_H
@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <limits>
+#include "opencldevices.h"
+#include "nbodybackend2d.h"
+#include "openclprogramcache.h"
+
+
+std::vector<OpenCLDeviceInfo> OpenCLDevices::rank(const std::vector<std::string>& sources,
+    const std::string& program_cache_directory)
+{
+    std::vector<OpenCLDeviceInfo> devices;
+    std::vector<cl::Platform> ocl_platforms;
+    cl::Platform::get(&ocl_platforms);
+
+    for (const cl::Platform& ocl_platform : ocl_platforms) {
+        std::vector<cl::Device> ocl_devices;
+        if (ocl_platform.getDevices(CL_DEVICE_TYPE_ALL, &ocl_devices) != CL_SUCCESS) {
+            continue;
+        }
+
+        for (const cl::Device& ocl_device : ocl_devices) {
+            OpenCLDeviceInfo info;
+            info.platform = ocl_platform;
+            info.device = ocl_device;
+            info.platform_name = ocl_platform.getInfo<CL_PLATFORM_NAME>();
+            info.device_name = ocl_device.getInfo<CL_DEVICE_NAME>();
+            info.compute_units = ocl_device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
+            info.clock_frequency = ocl_device.getInfo<CL_DEVICE_MAX_CLOCK_FREQUENCY>();
+            info.benchmark_rate = benchmark(ocl_device, sources, program_cache_directory);
+            devices.push_back(info);
+        }
+    }
+
+    // stable, so that equal devices keep the order of the platforms
+    std::stable_sort(devices.begin(), devices.end(), [](const OpenCLDeviceInfo& a, const OpenCLDeviceInfo& b) {
+        if (a.benchmark_rate != b.benchmark_rate) {
+            return a.benchmark_rate > b.benchmark_rate;
+        }
+
+        return static_cast<uint64_t>(a.compute_units) * a.clock_frequency > static_cast<uint64_t>(b.compute_units) * b.clock_frequency;
+    });
+
+    return devices;
+}
+
+double OpenCLDevices::benchmark(const cl::Device& ocl_device, const std::vector<std::string>& sources,
+    const std::string& program_cache_directory)
+{
+    // any failure only means the device is ranked by its specification
+    cl_int ocl_err;
+    cl::Context ocl_context(ocl_device, nullptr, nullptr, nullptr, &ocl_err);
+    if (ocl_err != CL_SUCCESS) {
+        return 0.0;
+    }
+
+    cl::Program ocl_program;
+    std::string error_message;
+    if (!OpenCLProgramCache(program_cache_directory).build(ocl_context, sources, "-cl-std=CL1.1", ocl_program, error_message)) {
+        return 0.0;
+    }
+
+    cl::Kernel ocl_kernel(ocl_program, "accelerations", &ocl_err);
+    if (ocl_err != CL_SUCCESS) {
+        return 0.0;
+    }
+
+    std::vector<float> locations = NBodyBackend2D::generateRandomBodies(BENCHMARK_POINTS, 1.0f, 1.0f, 1.0f);
+    cl::Buffer ocl_buffer_pos(ocl_context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, locations.size() * sizeof(float), locations.data(), &ocl_err);
+    if (ocl_err != CL_SUCCESS) {
+        return 0.0;
+    }
+
+    cl::Buffer ocl_buffer_acc(ocl_context, CL_MEM_WRITE_ONLY, BENCHMARK_POINTS * 2 * sizeof(float), nullptr, &ocl_err);
+    if (ocl_err != CL_SUCCESS) {
+        return 0.0;
+    }
+
+    cl::CommandQueue ocl_cmd_queue(ocl_context, ocl_device, cl::QueueProperties::Profiling, &ocl_err);
+    if ((ocl_err != CL_SUCCESS) ||
+        (ocl_kernel.setArg(0, ocl_buffer_pos) != CL_SUCCESS) ||
+        (ocl_kernel.setArg(1, ocl_buffer_acc) != CL_SUCCESS) ||
+        (ocl_kernel.setArg(2, 1.0f) != CL_SUCCESS) ||
+        (ocl_kernel.setArg(3, 0.0f) != CL_SUCCESS)) {
+        return 0.0;
+    }
+
+    double time = std::numeric_limits<double>::infinity();
+    for (int run = 0; run <= BENCHMARK_RUNS; run++) {
+        cl::Event ocl_event;
+        if ((ocl_cmd_queue.enqueueNDRangeKernel(ocl_kernel, cl::NDRange(0), cl::NDRange(BENCHMARK_POINTS), cl::NullRange, nullptr, &ocl_event) != CL_SUCCESS) ||
+            (ocl_event.wait() != CL_SUCCESS)) {
+            return 0.0;
+        }
+
+        if (run > 0) {
+            const cl_ulong start = ocl_event.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+            const cl_ulong end = ocl_event.getProfilingInfo<CL_PROFILING_COMMAND_END>();
+            time = std::min(time, static_cast<double>(end - start) * 1.0e-9);
+        }
+    }
+
+    if (!(time > 0.0) || (time == std::numeric_limits<double>::infinity())) {
+        return 0.0;
+    }
+
+    return static_cast<double>(BENCHMARK_POINTS) * BENCHMARK_POINTS / time;
+}
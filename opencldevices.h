@@ -0,0 +1,38 @@
+#ifndef OPENCLDEVICES_H
+#define OPENCLDEVICES_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define CL_HPP_MINIMUM_OPENCL_VERSION 110
+#define CL_HPP_TARGET_OPENCL_VERSION 110
+#include <CL/cl2.hpp>
+
+struct OpenCLDeviceInfo {
+    cl::Platform platform;
+    cl::Device device;
+    std::string platform_name;
+    std::string device_name;
+    cl_uint compute_units = 0;
+    cl_uint clock_frequency = 0; // [MHz]
+    double benchmark_rate = 0.0; // interactions per second of the "accelerations" kernel, 0 if it did not run
+};
+
+// Finds the OpenCL devices of every platform and ranks them, fastest first.
+class OpenCLDevices {
+public:
+    // Ranks by a short run of the "accelerations" kernel from sources, then by compute units times clock for
+    // devices where it cannot run. Programs go through the binary cache in program_cache_directory.
+    static std::vector<OpenCLDeviceInfo> rank(const std::vector<std::string>& sources,
+        const std::string& program_cache_directory);
+
+private:
+    static constexpr uint32_t BENCHMARK_POINTS = 4096;
+    static constexpr int BENCHMARK_RUNS = 2; // timed runs, after one warm-up run
+
+    static double benchmark(const cl::Device& ocl_device, const std::vector<std::string>& sources,
+        const std::string& program_cache_directory);
+};
+
+#endif // OPENCLDEVICES_H
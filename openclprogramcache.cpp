@@ -0,0 +1,146 @@
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include "openclprogramcache.h"
+
+
+OpenCLProgramCache::OpenCLProgramCache(const std::string& directory) :
+    m_directory(directory)
+{
+}
+
+bool OpenCLProgramCache::build(const cl::Context& ocl_context, const std::vector<std::string>& sources,
+    const std::string& options, cl::Program& ocl_program, std::string& error_message) const
+{
+    std::vector<cl::Device> ocl_devices = ocl_context.getInfo<CL_CONTEXT_DEVICES>();
+    std::vector<std::string> file_paths;
+    if (!m_directory.empty()) {
+        for (const cl::Device& ocl_device : ocl_devices) {
+            file_paths.push_back(cacheFilePath(ocl_device, sources, options));
+        }
+
+        if (buildFromBinaries(ocl_context, ocl_devices, file_paths, options, ocl_program)) {
+            return true;
+        }
+    }
+
+    cl_int ocl_err;
+    ocl_program = cl::Program(ocl_context, sources, &ocl_err);
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "Cannot create OpenCL program. Error: " + std::to_string(ocl_err);
+        return false;
+    }
+
+    ocl_err = ocl_program.build(options.c_str());
+    if (ocl_err != CL_SUCCESS) {
+        error_message = "OpenCL build error: " + std::to_string(ocl_err) + "\n";
+        auto build_info = ocl_program.getBuildInfo<CL_PROGRAM_BUILD_LOG>();
+        for (auto& device_log_pair : build_info) {
+            error_message += device_log_pair.second + "\n";
+        }
+        return false;
+    }
+
+    if (!m_directory.empty()) {
+        storeBinaries(ocl_program, file_paths);
+    }
+
+    return true;
+}
+
+uint64_t OpenCLProgramCache::hash(uint64_t hash, const std::string& text)
+{
+    // FNV-1a over the length and the characters, so that concatenations cannot collide trivially
+    const std::string length = std::to_string(text.size()) + ":";
+    for (char c : length + text) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+std::string OpenCLProgramCache::cacheFilePath(const cl::Device& ocl_device, const std::vector<std::string>& sources,
+    const std::string& options) const
+{
+    uint64_t key = FNV_OFFSET_BASIS;
+    for (const std::string& source : sources) {
+        key = hash(key, source);
+    }
+
+    key = hash(key, options);
+    key = hash(key, ocl_device.getInfo<CL_DEVICE_NAME>());
+    key = hash(key, ocl_device.getInfo<CL_DRIVER_VERSION>());
+    key = hash(key, cl::Platform(ocl_device.getInfo<CL_DEVICE_PLATFORM>()).getInfo<CL_PLATFORM_NAME>());
+
+    char file_name[32];
+    std::snprintf(file_name, sizeof(file_name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(m_directory) / file_name).string();
+}
+
+bool OpenCLProgramCache::buildFromBinaries(const cl::Context& ocl_context, const std::vector<cl::Device>& ocl_devices,
+    const std::vector<std::string>& file_paths, const std::string& options, cl::Program& ocl_program) const
+{
+    cl::Program::Binaries binaries;
+    for (const std::string& file_path : file_paths) {
+        std::ifstream binary_file(file_path, std::ios::binary);
+        if (!binary_file) {
+            return false;
+        }
+
+        binaries.emplace_back(std::istreambuf_iterator<char>(binary_file), std::istreambuf_iterator<char>());
+        if (binaries.back().empty()) {
+            return false;
+        }
+    }
+
+    // a driver update or a damaged file shows up as an error here, then the program is built from source
+    cl_int ocl_err;
+    std::vector<cl_int> binary_status;
+    cl::Program binary_program(ocl_context, ocl_devices, binaries, &binary_status, &ocl_err);
+    if (ocl_err != CL_SUCCESS) {
+        return false;
+    }
+
+    if (binary_program.build(options.c_str()) != CL_SUCCESS) {
+        return false;
+    }
+
+    ocl_program = binary_program;
+    return true;
+}
+
+void OpenCLProgramCache::storeBinaries(const cl::Program& ocl_program, const std::vector<std::string>& file_paths) const
+{
+    // the cache is optional, failures to write it are ignored
+    cl_int ocl_err;
+    cl::Program::Binaries binaries = ocl_program.getInfo<CL_PROGRAM_BINARIES>(&ocl_err);
+    if ((ocl_err != CL_SUCCESS) || (binaries.size() != file_paths.size())) {
+        return;
+    }
+
+    std::error_code fs_err;
+    std::filesystem::create_directories(m_directory, fs_err);
+    if (fs_err) {
+        return;
+    }
+
+    for (size_t i = 0; i < binaries.size(); i++) {
+        if (binaries[i].empty()) {
+            continue;
+        }
+
+        // write next to the final file and rename, so that a crash never leaves a truncated binary behind
+        const std::string temp_path = file_paths[i] + ".tmp";
+        {
+            std::ofstream binary_file(temp_path, std::ios::binary | std::ios::trunc);
+            binary_file.write(reinterpret_cast<const char*>(binaries[i].data()), static_cast<std::streamsize>(binaries[i].size()));
+            if (!binary_file) {
+                continue;
+            }
+        }
+
+        std::filesystem::rename(temp_path, file_paths[i], fs_err);
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef OPENCLPROGRAMCACHE_H
+#define OPENCLPROGRAMCACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define CL_HPP_MINIMUM_OPENCL_VERSION 110
+#define CL_HPP_TARGET_OPENCL_VERSION 110
+#include <CL/cl2.hpp>
+
+// Builds OpenCL programs and keeps the compiled binaries on disk, one file per device, named after a hash of
+// the sources, the build options, the device name and the driver version. Missing or rejected binaries fall
+// back to a build from source, which then refreshes the cache.
+class OpenCLProgramCache {
+public:
+    // An empty directory disables the cache.
+    explicit OpenCLProgramCache(const std::string& directory);
+
+    bool build(const cl::Context& ocl_context, const std::vector<std::string>& sources, const std::string& options,
+        cl::Program& ocl_program, std::string& error_message) const;
+
+private:
+    static constexpr uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ull;
+    static constexpr uint64_t FNV_PRIME = 0x100000001b3ull;
+
+    std::string m_directory;
+
+    static uint64_t hash(uint64_t hash, const std::string& text);
+    std::string cacheFilePath(const cl::Device& ocl_device, const std::vector<std::string>& sources,
+        const std::string& options) const;
+    bool buildFromBinaries(const cl::Context& ocl_context, const std::vector<cl::Device>& ocl_devices,
+        const std::vector<std::string>& file_paths, const std::string& options, cl::Program& ocl_program) const;
+    void storeBinaries(const cl::Program& ocl_program, const std::vector<std::string>& file_paths) const;
+};
+
+#endif // OPENCLPROGRAMCACHE_H
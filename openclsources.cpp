@@ -0,0 +1,21 @@
+#include <QFile>
+#include "openclsources.h"
+
+
+bool OpenCLSources::load(std::vector<std::string>& sources, std::string& error_message)
+{
+    sources.clear();
+
+    for (const char* file_name : FILE_NAMES) {
+        QFile source_file(file_name);
+        if (!source_file.open(QIODevice::ReadOnly)) {
+            error_message = std::string("Cannot open OpenCL source file (") + file_name + ").";
+            return false;
+        }
+
+        sources.push_back(source_file.readAll().toStdString());
+        source_file.close();
+    }
+
+    return true;
+}
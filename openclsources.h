@@ -0,0 +1,21 @@
+#ifndef OPENCLSOURCES_H
+#define OPENCLSOURCES_H
+
+#include <string>
+#include <vector>
+
+class OpenCLSources {
+public:
+    // Reads the OpenCL kernel sources compiled into the Qt resources.
+    static bool load(std::vector<std::string>& sources, std::string& error_message);
+
+private:
+    static constexpr const char* FILE_NAMES[] = {
+        ":/specialisation.cl",
+        ":/gravity.cl",
+        ":/leapfrog.cl",
+        ":/radixtree.cl"
+    };
+};
+
+#endif // OPENCLSOURCES_H
@@ -21,19 +21,66 @@ bool OpenGLSceneWidget::initVertices(const std::vector<float>& vertices_data, QS
         return false;
     }
 
-    if (!m_vertex_buffer.bind()) {
+    for (QOpenGLBuffer& vertex_buffer : m_vertex_buffers) {
+        if (!vertex_buffer.bind()) {
+            error_message = "Cannot bind OpenGL vertex buffer.";
+            return false;
+        }
+
+        vertex_buffer.allocate(vertices_data.data(), static_cast<int>(vertices_data.size() * sizeof(float)));
+        vertex_buffer.release();
+    }
+
+    return true;
+}
+
+bool OpenGLSceneWidget::updateVertices(const std::vector<float>& vertices_data, QString& error_message)
+{
+    if (!m_opengl_initialized) {
+        error_message = "OpenGL not initialized.";
+        return false;
+    }
+
+    makeCurrent();
+
+    QOpenGLBuffer& vertex_buffer = m_vertex_buffers[m_front_buffer];
+    if (!vertex_buffer.bind()) {
+        doneCurrent();
         error_message = "Cannot bind OpenGL vertex buffer.";
         return false;
     }
 
-    m_vertex_buffer.allocate(vertices_data.data(), static_cast<int>(vertices_data.size() * sizeof(float)));
-    m_vertex_buffer.release();
+    if (static_cast<int>(vertices_data.size() * sizeof(float)) != vertex_buffer.size()) {
+        vertex_buffer.release();
+        doneCurrent();
+        error_message = "Number of vertices does not match OpenGL vertex buffer size.";
+        return false;
+    }
+
+    vertex_buffer.write(0, vertices_data.data(), static_cast<int>(vertices_data.size() * sizeof(float)));
+    vertex_buffer.release();
+    doneCurrent();
     return true;
 }
 
-GLuint OpenGLSceneWidget::getVertexBufferId() const
+GLuint OpenGLSceneWidget::getVertexBufferId(int index) const
 {
-    return m_vertex_buffer.bufferId();
+    return m_vertex_buffers[index].bufferId();
+}
+
+void OpenGLSceneWidget::setFrontBuffer(int index)
+{
+    m_front_buffer = index;
+}
+
+int OpenGLSceneWidget::getFrontBuffer() const
+{
+    return m_front_buffer;
+}
+
+GLsync OpenGLSceneWidget::getDrawFence() const
+{
+    return m_draw_fence;
 }
 
 void OpenGLSceneWidget::setZoom(float zoom)
@@ -76,6 +123,10 @@ void OpenGLSceneWidget::initializeGL()
     glDisable(GL_DEPTH_TEST);
     glEnable(GL_PROGRAM_POINT_SIZE);
 
+    const QSurfaceFormat format = context()->format();
+    m_sync_supported = context()->isOpenGLES() ? (format.majorVersion() >= 3) :
+        ((format.version() >= qMakePair(3, 2)) || context()->hasExtension("GL_ARB_sync"));
+
     m_shader_program = new QOpenGLShaderProgram;
 
     if (!m_shader_program->addCacheableShaderFromSourceFile(QOpenGLShader::Vertex, ":/openglscenevertex.vert")) {
@@ -106,10 +157,12 @@ void OpenGLSceneWidget::initializeGL()
     m_shader_program->setUniformValue("point_size", POINT_SIZE);
     m_shader_program->release();
 
-    if (!m_vertex_buffer.create()) {
-        emit errorOccurred("Cannot create OpenGL vertex buffer.");
-        destroyGL();
-        return;
+    for (QOpenGLBuffer& vertex_buffer : m_vertex_buffers) {
+        if (!vertex_buffer.create()) {
+            emit errorOccurred("Cannot create OpenGL vertex buffer.");
+            destroyGL();
+            return;
+        }
     }
 
     m_opengl_initialized = true;
@@ -123,7 +176,15 @@ void OpenGLSceneWidget::destroyGL()
         m_shader_program = nullptr;
     }
 
-    m_vertex_buffer.destroy();
+    if (m_draw_fence != nullptr) {
+        context()->extraFunctions()->glDeleteSync(m_draw_fence);
+        m_draw_fence = nullptr;
+    }
+
+    for (QOpenGLBuffer& vertex_buffer : m_vertex_buffers) {
+        vertex_buffer.destroy();
+    }
+
     m_opengl_initialized = false;
     emit openGlDestroyed();
 }
@@ -161,17 +222,28 @@ void OpenGLSceneWidget::paintGL()
 
     m_shader_program->enableAttributeArray("position");
 
-    if (!m_vertex_buffer.bind()) {
+    QOpenGLBuffer& vertex_buffer = m_vertex_buffers[m_front_buffer];
+    if (!vertex_buffer.bind()) {
         emit errorOccurred("Cannot bind OpenGL vertex buffer.");
         destroyGL();
         return;
     }
 
-    m_shader_program->setAttributeBuffer("position", GL_FLOAT, 0, 2, 0);
+    m_shader_program->setAttributeBuffer("position", GL_FLOAT, 0, 2, VERTEX_STRIDE * sizeof(float));
+
+    glDrawArrays(GL_POINTS, 0, vertex_buffer.size() / sizeof(float) / VERTEX_STRIDE);
 
-    glDrawArrays(GL_POINTS, 0, m_vertex_buffer.size() / sizeof(float) / 2);
+    if (m_sync_supported) {
+        QOpenGLExtraFunctions* extra_functions = context()->extraFunctions();
+        if (m_draw_fence != nullptr) {
+            extra_functions->glDeleteSync(m_draw_fence);
+        }
+
+        m_draw_fence = extra_functions->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
+    }
 
-    m_vertex_buffer.release();
+    vertex_buffer.release();
     m_shader_program->disableAttributeArray("position");
     m_shader_program->release();
 }
@@ -3,6 +3,7 @@
 
 #include <QOpenGLWidget>
 #include <QOpenGLFunctions>
+#include <QOpenGLExtraFunctions>
 #include <QOpenGLBuffer>
 #include <QOpenGLShaderProgram>
 
@@ -11,10 +12,20 @@ class OpenGLSceneWidget : public QOpenGLWidget, protected QOpenGLFunctions {
     Q_OBJECT
 
 public:
+    static constexpr int NUM_VERTEX_BUFFERS = 2; // the simulation writes one while the other one is drawn
+    static constexpr int VERTEX_STRIDE = 4; // floats per vertex: x, y, then the mass and one unused float
+
     explicit OpenGLSceneWidget(QWidget* parent = nullptr);
     ~OpenGLSceneWidget();
     bool initVertices(const std::vector<float>& vertices_data, QString& error_message);
-    GLuint getVertexBufferId() const;
+    bool updateVertices(const std::vector<float>& vertices_data, QString& error_message);
+    GLuint getVertexBufferId(int index) const;
+    // Vertex buffer that is drawn and that updateVertices writes to.
+    void setFrontBuffer(int index);
+    int getFrontBuffer() const;
+    // Fence placed after the last draw from the vertex buffer, nullptr if the context has no sync objects.
+    // Stays valid until the next frame is drawn.
+    GLsync getDrawFence() const;
     void setZoom(float zoom);
     float getZoom() const;
 
@@ -28,8 +39,11 @@ private:
     static constexpr QVector4D POINT_COLOR{ 1.0f, 1.0f, 0.0f, 1.0f };
 
     bool m_opengl_initialized = false;
+    bool m_sync_supported = false;
+    GLsync m_draw_fence = nullptr;
     QOpenGLShaderProgram* m_shader_program = nullptr;
-    QOpenGLBuffer m_vertex_buffer = QOpenGLBuffer(QOpenGLBuffer::Type::VertexBuffer);
+    QOpenGLBuffer m_vertex_buffers[NUM_VERTEX_BUFFERS];
+    int m_front_buffer = 0;
     float m_zoom = 1.0f;
 
     float xScale(int w, int h);
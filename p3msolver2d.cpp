@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cmath>
+#include "p3msolver2d.h"
+
+
+P3mSolver2D::P3mSolver2D(ThreadPool& thread_pool, float attraction, float radius, uint32_t grid_size,
+    ForceSolverSettings2D::MassAssignment mass_assignment, float split_radius) :
+    PmSolver2D(thread_pool, attraction, radius, grid_size, mass_assignment),
+    m_split_radius(std::max(split_radius, 0.5f)),
+    m_short_range_table(SHORT_RANGE_TABLE_SIZE + 1)
+{
+    // erfc and exp are too slow for the inner loop, the fraction is smooth enough to interpolate linearly
+    for (uint32_t i = 0; i <= SHORT_RANGE_TABLE_SIZE; i++) {
+        const double dist = CUTOFF_SPLIT_RADII * static_cast<double>(i) / SHORT_RANGE_TABLE_SIZE;
+        m_short_range_table[i] = (i == 0) ? 1.0 : shortRangeKernel(dist, 1.0) * dist * dist * dist;
+    }
+}
+
+
+void P3mSolver2D::computeAccelerations(const std::vector<float>& pos_x, const std::vector<float>& pos_y,
+    const std::vector<float>& mass, std::vector<float>& acc_x, std::vector<float>& acc_y)
+{
+    computeMeshAccelerations(pos_x, pos_y, mass, acc_x, acc_y);
+
+    if (pos_x.empty()) {
+        return;
+    }
+
+    // cell list with cells as large as the cutoff, so that only the 3 x 3 neighbouring cells are searched
+    const uint32_t num_points = static_cast<uint32_t>(pos_x.size());
+    const double split_radius = m_split_radius * m_cell_size;
+    const double cutoff = CUTOFF_SPLIT_RADII * split_radius;
+    const double extent = (m_grid_size - 1) * m_cell_size;
+    const int side = std::max(static_cast<int>(extent / cutoff), 1);
+    const double list_cell_size = extent / side;
+
+    std::vector<uint32_t> point_cells(num_points);
+    m_cell_begin.assign(static_cast<size_t>(side) * side + 1, 0);
+    for (uint32_t i = 0; i < num_points; i++) {
+        const int cell_x = std::min(static_cast<int>((pos_x[i] - m_min_x) / list_cell_size), side - 1);
+        const int cell_y = std::min(static_cast<int>((pos_y[i] - m_min_y) / list_cell_size), side - 1);
+        point_cells[i] = static_cast<uint32_t>(cell_y * side + cell_x);
+        m_cell_begin[point_cells[i] + 1]++;
+    }
+    for (size_t cell = 0; cell + 1 < m_cell_begin.size(); cell++) {
+        m_cell_begin[cell + 1] += m_cell_begin[cell];
+    }
+
+    std::vector<uint32_t> next(m_cell_begin.begin(), m_cell_begin.end() - 1);
+    m_indices.resize(num_points);
+    for (uint32_t i = 0; i < num_points; i++) {
+        m_indices[next[point_cells[i]]++] = i;
+    }
+
+    m_sorted_x.resize(num_points);
+    m_sorted_y.resize(num_points);
+    m_sorted_mass.resize(num_points);
+    for (uint32_t i = 0; i < num_points; i++) {
+        m_sorted_x[i] = pos_x[m_indices[i]];
+        m_sorted_y[i] = pos_y[m_indices[i]];
+        m_sorted_mass[i] = mass[m_indices[i]];
+    }
+
+    const double cutoff_2 = cutoff * cutoff;
+    const double rad_2 = static_cast<double>(m_radius) * static_cast<double>(m_radius);
+    const double table_scale = SHORT_RANGE_TABLE_SIZE / cutoff;
+
+    m_thread_pool.parallelFor(static_cast<size_t>(side) * side, [&](size_t begin, size_t end) {
+        for (size_t cell = begin; cell < end; cell++) {
+            const int cell_x = static_cast<int>(cell % side);
+            const int cell_y = static_cast<int>(cell / side);
+
+            for (uint32_t i = m_cell_begin[cell]; i < m_cell_begin[cell + 1]; i++) {
+                double sum_x = 0.0;
+                double sum_y = 0.0;
+
+                for (int neighbour_y = std::max(cell_y - 1, 0); neighbour_y <= std::min(cell_y + 1, side - 1); neighbour_y++) {
+                    for (int neighbour_x = std::max(cell_x - 1, 0); neighbour_x <= std::min(cell_x + 1, side - 1); neighbour_x++) {
+                        const size_t neighbour = static_cast<size_t>(neighbour_y * side + neighbour_x);
+                        for (uint32_t j = m_cell_begin[neighbour]; j < m_cell_begin[neighbour + 1]; j++) {
+                            const double dx = static_cast<double>(m_sorted_x[j]) - m_sorted_x[i];
+                            const double dy = static_cast<double>(m_sorted_y[j]) - m_sorted_y[i];
+                            const double dist_2 = dx * dx + dy * dy;
+                            if ((dist_2 >= cutoff_2) || (j == i)) {
+                                continue;
+                            }
+
+                            const double dist = std::sqrt(dist_2);
+                            double kernel;
+                            if (dist_2 > rad_2) {
+                                const double position = dist * table_scale;
+                                const uint32_t index = static_cast<uint32_t>(position);
+                                const double fraction = position - index;
+                                kernel = (m_short_range_table[index] * (1.0 - fraction) +
+                                    m_short_range_table[index + 1] * fraction) / (dist_2 * dist);
+                            } else {
+                                // inside the radius there is no force, cancel the mesh part instead
+                                kernel = -longRangeKernel(dist, split_radius);
+                            }
+                            sum_x += m_sorted_mass[j] * dx * kernel;
+                            sum_y += m_sorted_mass[j] * dy * kernel;
+                        }
+                    }
+                }
+
+                acc_x[m_indices[i]] += static_cast<float>(m_attraction * sum_x);
+                acc_y[m_indices[i]] += static_cast<float>(m_attraction * sum_y);
+            }
+        }
+    });
+}
+
+
+double P3mSolver2D::meshKernel(double dist) const
+{
+    return longRangeKernel(dist, m_split_radius);
+}
+
+
+double P3mSolver2D::longRangeKernel(double dist, double split_radius) const
+{
+    // Gaussian smoothed part erf(r / 2s) / r, series near zero where the difference below cancels
+    static const double inv_sqrt_pi = 1.0 / std::sqrt(std::acos(-1.0));
+    const double u = dist / (2.0 * split_radius);
+    if (u < 0.1) {
+        return inv_sqrt_pi / (6.0 * split_radius * split_radius * split_radius) * (1.0 - 0.6 * u * u);
+    }
+    return 1.0 / (dist * dist * dist) - shortRangeKernel(dist, split_radius);
+}
+
+
+double P3mSolver2D::shortRangeKernel(double dist, double split_radius) const
+{
+    // 1/r potential minus its Gaussian smoothed part: erfc(r / 2s) / r, force divided by r
+    static const double inv_sqrt_pi = 1.0 / std::sqrt(std::acos(-1.0));
+    const double u = dist / (2.0 * split_radius);
+    return (std::erfc(u) / dist + inv_sqrt_pi * std::exp(-u * u) / split_radius) / (dist * dist);
+}
@@ -0,0 +1,37 @@
+#ifndef P3MSOLVER2D_H
+#define P3MSOLVER2D_H
+
+#include <cstdint>
+#include "pmsolver2d.h"
+
+// Particle-particle particle-mesh solver. The force is split with a Gaussian of width split_radius grid cells:
+// the smooth long range part comes from the mesh, the short range rest from a direct sum over neighbouring
+// cells of a cell list. A larger split radius is more accurate and moves work from the mesh to the direct sum.
+class P3mSolver2D : public PmSolver2D {
+public:
+    P3mSolver2D(ThreadPool& thread_pool, float attraction, float radius, uint32_t grid_size,
+        ForceSolverSettings2D::MassAssignment mass_assignment, float split_radius);
+
+    void computeAccelerations(const std::vector<float>& pos_x, const std::vector<float>& pos_y,
+        const std::vector<float>& mass, std::vector<float>& acc_x, std::vector<float>& acc_y) override;
+
+protected:
+    double meshKernel(double dist) const override;
+
+private:
+    static constexpr double CUTOFF_SPLIT_RADII = 5.0; // short range force is below 1% of the full force there
+    static constexpr uint32_t SHORT_RANGE_TABLE_SIZE = 1024;
+
+    double m_split_radius;
+    std::vector<uint32_t> m_cell_begin; // cell -> first point in cell order, one extra entry at the end
+    std::vector<uint32_t> m_indices; // cell order -> point index
+    std::vector<float> m_sorted_x;
+    std::vector<float> m_sorted_y;
+    std::vector<float> m_sorted_mass;
+    std::vector<double> m_short_range_table; // short range fraction of the force over dist / split radius
+
+    double shortRangeKernel(double dist, double split_radius) const;
+    double longRangeKernel(double dist, double split_radius) const;
+};
+
+#endif // P3MSOLVER2D_H
@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <cmath>
+#include "pmsolver2d.h"
+
+
+static uint32_t roundGridSize(uint32_t grid_size, uint32_t min_grid_size)
+{
+    uint32_t rounded = min_grid_size;
+    while (rounded < grid_size) {
+        rounded *= 2;
+    }
+    return rounded;
+}
+
+
+PmSolver2D::PmSolver2D(ThreadPool& thread_pool, float attraction, float radius, uint32_t grid_size,
+    ForceSolverSettings2D::MassAssignment mass_assignment) :
+    m_thread_pool(thread_pool),
+    m_attraction(attraction),
+    m_radius(radius),
+    m_grid_size(roundGridSize(grid_size, MIN_GRID_SIZE)),
+    m_mass_assignment(mass_assignment),
+    m_padded_size(m_grid_size * 2),
+    m_fft(m_padded_size)
+{
+}
+
+
+void PmSolver2D::computeAccelerations(const std::vector<float>& pos_x, const std::vector<float>& pos_y,
+    const std::vector<float>& mass, std::vector<float>& acc_x, std::vector<float>& acc_y)
+{
+    computeMeshAccelerations(pos_x, pos_y, mass, acc_x, acc_y);
+}
+
+
+void PmSolver2D::computeMeshAccelerations(const std::vector<float>& pos_x, const std::vector<float>& pos_y,
+    const std::vector<float>& mass, std::vector<float>& acc_x, std::vector<float>& acc_y)
+{
+    acc_x.resize(pos_x.size());
+    acc_y.resize(pos_y.size());
+
+    if (pos_x.empty()) {
+        return;
+    }
+
+    // the kernel is built on first use so that derived classes can replace meshKernel()
+    if (m_kernel.empty()) {
+        buildKernel();
+    }
+
+    auto [min_x, max_x] = std::minmax_element(pos_x.begin(), pos_x.end());
+    auto [min_y, max_y] = std::minmax_element(pos_y.begin(), pos_y.end());
+    m_cell_size = std::max(std::max(*max_x - *min_x, *max_y - *min_y), 1.0f) /
+        static_cast<double>(m_grid_size - 2 * GRID_MARGIN - 1);
+    m_min_x = *min_x - GRID_MARGIN * m_cell_size;
+    m_min_y = *min_y - GRID_MARGIN * m_cell_size;
+
+    // mass assignment
+    std::fill(m_grid.begin(), m_grid.end(), std::complex<double>(0.0, 0.0));
+    for (size_t i = 0; i < pos_x.size(); i++) {
+        uint32_t first_x, first_y;
+        double weights_x[3], weights_y[3];
+        const uint32_t num_weights = assignmentWeights((pos_x[i] - m_min_x) / m_cell_size, first_x, weights_x);
+        assignmentWeights((pos_y[i] - m_min_y) / m_cell_size, first_y, weights_y);
+
+        for (uint32_t y = 0; y < num_weights; y++) {
+            for (uint32_t x = 0; x < num_weights; x++) {
+                m_grid[(first_y + y) * m_padded_size + first_x + x] += mass[i] * weights_x[x] * weights_y[y];
+            }
+        }
+    }
+
+    // convolution, rows past the grid are zero on the way in and not needed on the way out
+    transformGrid(m_grid, m_grid_size, false);
+    for (size_t i = 0; i < m_grid.size(); i++) {
+        m_grid[i] *= m_kernel[i];
+    }
+    transformGrid(m_grid, m_grid_size, true);
+
+    // interpolation
+    const double scale = static_cast<double>(m_attraction) /
+        (m_cell_size * m_cell_size * static_cast<double>(m_padded_size) * static_cast<double>(m_padded_size));
+
+    m_thread_pool.parallelFor(pos_x.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            uint32_t first_x, first_y;
+            double weights_x[3], weights_y[3];
+            const uint32_t num_weights = assignmentWeights((pos_x[i] - m_min_x) / m_cell_size, first_x, weights_x);
+            assignmentWeights((pos_y[i] - m_min_y) / m_cell_size, first_y, weights_y);
+
+            std::complex<double> sum(0.0, 0.0);
+            for (uint32_t y = 0; y < num_weights; y++) {
+                for (uint32_t x = 0; x < num_weights; x++) {
+                    sum += m_grid[(first_y + y) * m_padded_size + first_x + x] * (weights_x[x] * weights_y[y]);
+                }
+            }
+
+            acc_x[i] = static_cast<float>(sum.real() * scale);
+            acc_y[i] = static_cast<float>(sum.imag() * scale);
+        }
+    });
+}
+
+
+double PmSolver2D::meshKernel(double dist) const
+{
+    return 1.0 / (dist * dist * dist);
+}
+
+
+void PmSolver2D::buildKernel()
+{
+    // acceleration at node n is the sum over nodes m of density(m) * (m - n) * kernel(|m - n|),
+    // stored as a convolution kernel at offset n - m with wrap around
+    m_kernel.assign(static_cast<size_t>(m_padded_size) * m_padded_size, std::complex<double>(0.0, 0.0));
+    m_grid.assign(m_kernel.size(), std::complex<double>(0.0, 0.0));
+
+    const int grid_size = static_cast<int>(m_grid_size);
+    for (int offset_y = 1 - grid_size; offset_y < grid_size; offset_y++) {
+        for (int offset_x = 1 - grid_size; offset_x < grid_size; offset_x++) {
+            if ((offset_x == 0) && (offset_y == 0)) {
+                continue;
+            }
+
+            const double dist = std::sqrt(static_cast<double>(offset_x * offset_x + offset_y * offset_y));
+            const double kernel = meshKernel(dist);
+            const uint32_t x = static_cast<uint32_t>((offset_x + static_cast<int>(m_padded_size)) % m_padded_size);
+            const uint32_t y = static_cast<uint32_t>((offset_y + static_cast<int>(m_padded_size)) % m_padded_size);
+            m_kernel[y * m_padded_size + x] = std::complex<double>(-offset_x * kernel, -offset_y * kernel);
+        }
+    }
+
+    transformGrid(m_kernel, m_padded_size, false);
+}
+
+
+void PmSolver2D::transformGrid(std::vector<std::complex<double>>& grid, uint32_t num_rows, bool inverse)
+{
+    auto transform_rows = [this, &grid, inverse](size_t begin, size_t end) {
+        for (size_t row = begin; row < end; row++) {
+            m_fft.transform(&grid[row * m_padded_size], inverse);
+        }
+    };
+
+    auto transform_columns = [this, &grid, inverse](size_t begin, size_t end) {
+        std::vector<std::complex<double>> column(m_padded_size);
+        for (size_t x = begin; x < end; x++) {
+            for (size_t y = 0; y < m_padded_size; y++) {
+                column[y] = grid[y * m_padded_size + x];
+            }
+            m_fft.transform(column.data(), inverse);
+            for (size_t y = 0; y < m_padded_size; y++) {
+                grid[y * m_padded_size + x] = column[y];
+            }
+        }
+    };
+
+    if (inverse) {
+        m_thread_pool.parallelFor(m_padded_size, transform_columns);
+        m_thread_pool.parallelFor(num_rows, transform_rows);
+    } else {
+        m_thread_pool.parallelFor(num_rows, transform_rows);
+        m_thread_pool.parallelFor(m_padded_size, transform_columns);
+    }
+}
+
+
+uint32_t PmSolver2D::assignmentWeights(double position, uint32_t& first_node, double weights[3]) const
+{
+    if (m_mass_assignment == ForceSolverSettings2D::MassAssignment::Cic) {
+        const double node = std::floor(position);
+        const double fraction = position - node;
+        first_node = static_cast<uint32_t>(node);
+        weights[0] = 1.0 - fraction;
+        weights[1] = fraction;
+        return 2;
+    }
+
+    const double node = std::floor(position + 0.5);
+    const double fraction = position - node;
+    first_node = static_cast<uint32_t>(node) - 1;
+    weights[0] = 0.5 * (0.5 - fraction) * (0.5 - fraction);
+    weights[1] = 0.75 - fraction * fraction;
+    weights[2] = 0.5 * (0.5 + fraction) * (0.5 + fraction);
+    return 3;
+}
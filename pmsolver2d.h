@@ -0,0 +1,51 @@
+#ifndef PMSOLVER2D_H
+#define PMSOLVER2D_H
+
+#include <complex>
+#include <cstdint>
+#include "fft.h"
+#include "forcesolver2d.h"
+
+// Particle-mesh solver. Deposits the point masses onto a grid around their bounding square, convolves the density
+// with the force kernel by FFT on a zero padded grid (isolated boundaries), and interpolates the accelerations
+// back with the same assignment scheme. Forces closer than about two grid cells are smoothed out.
+class PmSolver2D : public ForceSolver2D {
+public:
+    PmSolver2D(ThreadPool& thread_pool, float attraction, float radius, uint32_t grid_size,
+        ForceSolverSettings2D::MassAssignment mass_assignment);
+
+    void computeAccelerations(const std::vector<float>& pos_x, const std::vector<float>& pos_y,
+        const std::vector<float>& mass, std::vector<float>& acc_x, std::vector<float>& acc_y) override;
+
+protected:
+    ThreadPool& m_thread_pool;
+    float m_attraction;
+    float m_radius;
+    uint32_t m_grid_size; // nodes per side
+    double m_min_x = 0.0; // position of grid node (0, 0)
+    double m_min_y = 0.0;
+    double m_cell_size = 0.0;
+
+    // Overwrites acc_x and acc_y with the mesh accelerations.
+    void computeMeshAccelerations(const std::vector<float>& pos_x, const std::vector<float>& pos_y,
+        const std::vector<float>& mass, std::vector<float>& acc_x, std::vector<float>& acc_y);
+
+    // Force between two unit masses divided by their distance, both in grid cells. Default is 1 / dist^3.
+    virtual double meshKernel(double dist) const;
+
+private:
+    static constexpr uint32_t MIN_GRID_SIZE = 8;
+    static constexpr uint32_t GRID_MARGIN = 1; // empty nodes on each side so that the assignment stays inside
+
+    ForceSolverSettings2D::MassAssignment m_mass_assignment;
+    uint32_t m_padded_size; // twice the grid size, avoids wrap around of the periodic convolution
+    Fft m_fft;
+    std::vector<std::complex<double>> m_kernel; // transformed, x component real, y component imaginary
+    std::vector<std::complex<double>> m_grid;
+
+    void buildKernel();
+    void transformGrid(std::vector<std::complex<double>>& grid, uint32_t num_rows, bool inverse);
+    uint32_t assignmentWeights(double position, uint32_t& first_node, double weights[3]) const;
+};
+
+#endif // PMSOLVER2D_H
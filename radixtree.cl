@@ -0,0 +1,296 @@
+// Barnes-Hut on a binary radix tree over Morton keys (Karras 2012), built entirely on the device.
+// Leaves are the sorted points: node index n - 1 + k is leaf k, nodes 0 .. n - 2 are internal, 0 is the root.
+
+#define RADIX_BITS 4
+#define RADIX_DIGITS 16
+#define NO_PARENT 0xFFFFFFFFu
+#define TREE_STACK_SIZE 96
+
+uint spread_bits(uint value) {
+    value &= 0x0000FFFFu;
+    value = (value | (value << 8)) & 0x00FF00FFu;
+    value = (value | (value << 4)) & 0x0F0F0F0Fu;
+    value = (value | (value << 2)) & 0x33333333u;
+    value = (value | (value << 1)) & 0x55555555u;
+    return value;
+}
+
+// Padding entries past n get the largest key so that the stable sort keeps them at the end.
+kernel void morton_keys(global float4* pos, global uint* keys, global uint* values, const float max_pos_arg, const uint n_arg) {
+    uint i = get_global_id(0);
+    const float max_pos = MAX_POS(max_pos_arg);
+    const uint n = NUM_POINTS(n_arg);
+
+    if (i >= n) {
+        keys[i] = 0xFFFFFFFFu;
+        values[i] = i;
+        return;
+    }
+
+    float scale = 65536.0f / (2.0f * max_pos);
+    uint cell_x = (uint)clamp((int)((pos[i].x + max_pos) * scale), 0, 65535);
+    uint cell_y = (uint)clamp((int)((pos[i].y + max_pos) * scale), 0, 65535);
+    keys[i] = spread_bits(cell_x) | (spread_bits(cell_y) << 1);
+    values[i] = i;
+}
+
+// Counts the digits of one block of keys. Histograms are stored digit major: [digit][group].
+kernel void radix_histogram(global uint* keys, global uint* histograms, const uint shift, local uint* counts) {
+    uint lid = get_local_id(0);
+    uint group = get_group_id(0);
+    uint num_groups = get_num_groups(0);
+
+    if (lid < RADIX_DIGITS) {
+        counts[lid] = 0;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    uint digit = (keys[get_global_id(0)] >> shift) & (RADIX_DIGITS - 1);
+    atomic_inc(&counts[digit]);
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    if (lid < RADIX_DIGITS) {
+        histograms[lid * num_groups + group] = counts[lid];
+    }
+}
+
+// Inclusive scan of one value per work-item in local memory.
+uint scan_local(local uint* data, uint value) {
+    uint lid = get_local_id(0);
+    uint size = get_local_size(0);
+
+    data[lid] = value;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (uint offset = 1; offset < size; offset *= 2) {
+        uint addend = (lid >= offset) ? data[lid - offset] : 0;
+        barrier(CLK_LOCAL_MEM_FENCE);
+        data[lid] += addend;
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    uint result = data[lid];
+    barrier(CLK_LOCAL_MEM_FENCE);
+    return result;
+}
+
+// Exclusive scan of all histograms in place. Runs as a single work-group.
+kernel void radix_scan(global uint* histograms, const uint count, local uint* sums) {
+    uint lid = get_local_id(0);
+    uint chunk = (count + get_local_size(0) - 1) / get_local_size(0);
+    uint begin = min(lid * chunk, count);
+    uint end = min(begin + chunk, count);
+
+    uint sum = 0;
+    for (uint k = begin; k < end; k++) {
+        sum += histograms[k];
+    }
+
+    uint prefix = scan_local(sums, sum) - sum;
+    for (uint k = begin; k < end; k++) {
+        uint value = histograms[k];
+        histograms[k] = prefix;
+        prefix += value;
+    }
+}
+
+// Stable scatter of one block of keys. The rank within the block is found by scanning
+// digit flags, two digits at a time packed into the halves of a uint.
+kernel void radix_scatter(global uint* keys_in, global uint* values_in, global uint* keys_out, global uint* values_out,
+    global uint* histograms, const uint shift, local uint* flags) {
+    uint gid = get_global_id(0);
+    uint group = get_group_id(0);
+    uint num_groups = get_num_groups(0);
+
+    uint key = keys_in[gid];
+    uint digit = (key >> shift) & (RADIX_DIGITS - 1);
+    uint rank = 0;
+
+    for (uint pair = 0; pair < RADIX_DIGITS / 2; pair++) {
+        uint flag = (digit == 2 * pair) ? 1u : ((digit == 2 * pair + 1) ? 0x10000u : 0u);
+        uint scanned = scan_local(flags, flag);
+        if (digit == 2 * pair) {
+            rank = (scanned & 0xFFFFu) - 1;
+        } else if (digit == 2 * pair + 1) {
+            rank = (scanned >> 16) - 1;
+        }
+    }
+
+    uint dst = histograms[digit * num_groups + group] + rank;
+    keys_out[dst] = key;
+    values_out[dst] = values_in[gid];
+}
+
+// Gathers the points into the order of the sorted slots, with their velocities and external ids. The stored
+// velocities are copied as raw words, so half storage loses nothing and needs no half support.
+kernel void reorder_points(global float4* pos, global uint* vel, global uint* ids, global uint* values,
+    global float4* pos_out, global uint* vel_out, global uint* ids_out, const uint n_arg) {
+    uint k = get_global_id(0);
+    if (k >= NUM_POINTS(n_arg)) {
+        return;
+    }
+
+    uint src = values[k];
+    pos_out[k] = pos[src];
+    for (uint w = 0; w < VECTOR_WORDS; w++) {
+        vel_out[VECTOR_WORDS * k + w] = vel[VECTOR_WORDS * src + w];
+    }
+    ids_out[k] = ids[src];
+}
+
+// Length of the common prefix of sorted keys i and j, extended by the index bits for equal keys.
+int common_prefix(global uint* keys, int i, int j, int n) {
+    if ((j < 0) || (j >= n)) {
+        return -1;
+    }
+
+    uint key_i = keys[i];
+    uint key_j = keys[j];
+    if (key_i == key_j) {
+        return 32 + (int)clz((uint)(i ^ j));
+    }
+
+    return (int)clz(key_i ^ key_j);
+}
+
+// One work-item per internal node. Also resets the bottom-up visit counters.
+kernel void radix_tree(global uint* keys, global uint* children, global uint* parents, global uint* visits, const uint n) {
+    int i = (int)get_global_id(0);
+    int num_points = (int)n;
+
+    // direction of the node's key range and the minimum prefix length outside it
+    int direction = (common_prefix(keys, i, i + 1, num_points) - common_prefix(keys, i, i - 1, num_points)) >= 0 ? 1 : -1;
+    int min_prefix = common_prefix(keys, i, i - direction, num_points);
+
+    int max_length = 2;
+    while (common_prefix(keys, i, i + max_length * direction, num_points) > min_prefix) {
+        max_length *= 2;
+    }
+
+    int length = 0;
+    for (int step = max_length / 2; step >= 1; step /= 2) {
+        if (common_prefix(keys, i, i + (length + step) * direction, num_points) > min_prefix) {
+            length += step;
+        }
+    }
+
+    int j = i + length * direction;
+    int node_prefix = common_prefix(keys, i, j, num_points);
+
+    // find the split position
+    int split = 0;
+    int step = length;
+    do {
+        step = (step + 1) / 2;
+        if (common_prefix(keys, i, i + (split + step) * direction, num_points) > node_prefix) {
+            split += step;
+        }
+    } while (step > 1);
+
+    int gamma = i + split * direction + min(direction, 0);
+
+    uint left = (min(i, j) == gamma) ? (uint)(num_points - 1 + gamma) : (uint)gamma;
+    uint right = (max(i, j) == gamma + 1) ? (uint)(num_points + gamma) : (uint)(gamma + 1);
+
+    children[2 * i] = left;
+    children[2 * i + 1] = right;
+    parents[left] = (uint)i;
+    parents[right] = (uint)i;
+    visits[i] = 0;
+
+    if (i == 0) {
+        parents[0] = NO_PARENT;
+    }
+}
+
+// One work-item per leaf. Copies the point in sorted order, then walks up the tree: the second
+// work-item to reach an internal node combines both children into its mass, centre of mass and bounds.
+// The node is opened for points closer than size / theta plus the offset of the centre of mass
+// from the centre of the bounds, which guards against elongated nodes with off-centre mass.
+kernel void radix_tree_nodes(global float4* pos, global uint* values, global uint* children, global uint* parents,
+    volatile global uint* visits, volatile global float4* node_mass, volatile global float4* node_bounds,
+    global float4* sorted_pos, const float theta, const uint n) {
+    uint k = get_global_id(0);
+    float4 point = pos[values[k]];
+    sorted_pos[k] = point;
+
+    uint node = parents[n - 1 + k];
+    while (node != NO_PARENT) {
+        mem_fence(CLK_GLOBAL_MEM_FENCE);
+        if (atomic_inc(&visits[node]) == 0) {
+            return;
+        }
+
+        float mass = 0.0f;
+        float2 weighted = (float2)(0.0f, 0.0f);
+        float4 bounds = (float4)(INFINITY, INFINITY, -INFINITY, -INFINITY);
+
+        for (uint c = 0; c < 2; c++) {
+            uint child = children[2 * node + c];
+            if (child >= n - 1) {
+                float4 child_point = pos[values[child - (n - 1)]];
+                mass += child_point.z;
+                weighted += child_point.z * child_point.xy;
+                bounds = (float4)(min(bounds.xy, child_point.xy), max(bounds.zw, child_point.xy));
+            } else {
+                float4 child_mass = node_mass[child];
+                float4 child_bounds = node_bounds[child];
+                mass += child_mass.z;
+                weighted += child_mass.z * child_mass.xy;
+                bounds = (float4)(min(bounds.xy, child_bounds.xy), max(bounds.zw, child_bounds.zw));
+            }
+        }
+
+        float2 center_of_mass = weighted / mass;
+        float size = max(bounds.z - bounds.x, bounds.w - bounds.y);
+        float offset = distance(center_of_mass, 0.5f * (bounds.xy + bounds.zw));
+        node_mass[node] = (float4)(center_of_mass, mass, size / theta + offset);
+        node_bounds[node] = bounds;
+        node = parents[node];
+    }
+}
+
+kernel void radix_tree_accelerations(global float4* sorted_pos, global uint* values, global uint* children,
+    global float4* node_mass, global VECTOR_STORAGE* acc, const float attr_arg, const float rad_arg, const uint n_arg) {
+    uint k = get_global_id(0);
+    const float attr = ATTRACTION(attr_arg);
+    const float rad = RADIUS(rad_arg);
+    const float inv_rad = 1.0f / rad;
+    const float inv_rad_3 = inv_rad * inv_rad * inv_rad;
+    const uint n = NUM_POINTS(n_arg);
+    float2 point = sorted_pos[k].xy;
+    SUM_DECLARE(sum);
+
+    uint stack[TREE_STACK_SIZE];
+    uint stack_size = 0;
+    stack[stack_size++] = 0;
+
+    while (stack_size > 0) {
+        uint node = stack[--stack_size];
+
+        if (node >= n - 1) {
+            uint leaf = node - (n - 1);
+            if (leaf != k) {
+                float4 body = sorted_pos[leaf];
+                float2 delta = body.xy - point;
+                SUM_ADD(sum, (attr * body.z * force_factor(dot(delta, delta), rad, inv_rad, inv_rad_3)) * delta);
+            }
+            continue;
+        }
+
+        float4 mass = node_mass[node];
+        float2 delta = mass.xy - point;
+        float dist_2 = dot(delta, delta);
+
+        if ((dist_2 > mass.w * mass.w) || (stack_size + 2 > TREE_STACK_SIZE)) {
+            // far enough away to be treated as a single point
+            SUM_ADD(sum, (attr * mass.z * force_factor(dist_2, rad, inv_rad, inv_rad_3)) * delta);
+            continue;
+        }
+
+        stack[stack_size++] = children[2 * node];
+        stack[stack_size++] = children[2 * node + 1];
+    }
+
+    STORE_VECTOR(SUM_RESULT(sum), acc, values[k], ACC_UNIT);
+}
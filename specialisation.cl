@@ -0,0 +1,133 @@
+// Constants of the run. The specialised build defines them with -D so that the compiler can fold them into the
+// kernels, the generic build leaves them undefined and the kernels read their arguments instead.
+
+#ifdef NBODY_ATTRACTION
+#define ATTRACTION(arg) NBODY_ATTRACTION
+#else
+#define ATTRACTION(arg) (arg)
+#endif
+
+#ifdef NBODY_RADIUS
+#define RADIUS(arg) NBODY_RADIUS
+#else
+#define RADIUS(arg) (arg)
+#endif
+
+#ifdef NBODY_TIME_STEP
+#define TIME_STEP(arg) NBODY_TIME_STEP
+#else
+#define TIME_STEP(arg) (arg)
+#endif
+
+#ifdef NBODY_MAX_POS
+#define MAX_POS(arg) NBODY_MAX_POS
+#else
+#define MAX_POS(arg) (arg)
+#endif
+
+#ifdef NBODY_MAX_VEL
+#define MAX_VEL(arg) NBODY_MAX_VEL
+#else
+#define MAX_VEL(arg) (arg)
+#endif
+
+#ifdef NBODY_NUM_POINTS
+#define NUM_POINTS(arg) NBODY_NUM_POINTS
+#else
+#define NUM_POINTS(arg) (arg)
+#endif
+
+#ifdef NBODY_TILE_SIZE
+#define TILE_SIZE NBODY_TILE_SIZE
+#else
+#define TILE_SIZE get_local_size(0)
+#endif
+
+// Unroll factor of the force loops, chosen by the autotuner. Drivers without the pragma ignore it.
+#define PRAGMA(text) _Pragma(#text)
+#define PRAGMA_UNROLL(factor) PRAGMA(unroll factor)
+
+#ifdef NBODY_UNROLL
+#define UNROLL_LOOP PRAGMA_UNROLL(NBODY_UNROLL)
+#else
+#define UNROLL_LOOP
+#endif
+
+// Precision of the force sums: plain float additions, Kahan compensation (NBODY_COMPENSATED) or a double accumulator
+// (NBODY_DOUBLE_SUMS, needs cl_khr_fp64). A sum is a SUM_STORAGE value, kept whole wherever it lives, in registers or
+// in the local and global buffers of the symmetric kernel, and turned into a float2 once at the end. SUM_MERGE adds
+// one sum to another. The compensation relies on the compiler keeping the order of the float additions, which it
+// does without -cl-fast-relaxed-math or -cl-unsafe-math-optimizations.
+#if defined(NBODY_DOUBLE_SUMS)
+#pragma OPENCL EXTENSION cl_khr_fp64 : enable
+#define SUM_STORAGE double2
+#define SUM_ZERO ((double2)(0.0, 0.0))
+#define SUM_ADD(sum, term) (sum) += convert_double2(term)
+#define SUM_MERGE(sum, other) (sum) += (other)
+#define SUM_RESULT(sum) convert_float2(sum)
+#elif defined(NBODY_COMPENSATED)
+#define SUM_STORAGE float4 // the sum in xy, the rounding error carried to the next term in zw
+#define SUM_ZERO ((float4)(0.0f, 0.0f, 0.0f, 0.0f))
+#define SUM_ADD(sum, term) { float2 term_ = (term) - (sum).zw; float2 total_ = (sum).xy + term_; (sum).zw = (total_ - (sum).xy) - term_; (sum).xy = total_; }
+#define SUM_MERGE(sum, other) { SUM_ADD(sum, (other).xy); SUM_ADD(sum, -(other).zw); }
+#define SUM_RESULT(sum) ((sum).xy)
+#else
+#define SUM_STORAGE float2
+#define SUM_ZERO ((float2)(0.0f, 0.0f))
+#define SUM_ADD(sum, term) (sum) += (term)
+#define SUM_MERGE(sum, other) (sum) += (other)
+#define SUM_RESULT(sum) (sum)
+#endif
+
+#define SUM_DECLARE(sum) SUM_STORAGE sum = SUM_ZERO
+
+// Force law of a pair, as the factor of attraction * mass * delta: a hard cutoff at RADIUS (default), Plummer
+// softening with RADIUS as the softening length (NBODY_FORCE_LAW_PLUMMER), or the cubic spline kernel of Monaghan
+// and Lattanzio in the form of Hernquist and Katz (NBODY_FORCE_LAW_SPLINE), Newtonian beyond RADIUS. Every case is
+// computed and the result selected, so the work-items of a pair loop do not diverge. The only root per pair is the
+// reciprocal one, the kernels pass 1 / RADIUS and its cube from outside their loops (folded into constants by the
+// specialised build). The plain float sums take the faster native_rsqrt.
+#if defined(NBODY_DOUBLE_SUMS) || defined(NBODY_COMPENSATED)
+#define RSQRT(x) rsqrt(x)
+#else
+#define RSQRT(x) native_rsqrt(x)
+#endif
+
+float force_factor(float dist_2, float rad, float inv_rad, float inv_rad_3) {
+#if defined(NBODY_FORCE_LAW_PLUMMER)
+    float inv_dist = RSQRT(dist_2 + rad * rad);
+    return inv_dist * inv_dist * inv_dist;
+#elif defined(NBODY_FORCE_LAW_SPLINE)
+    float inv_dist = RSQRT(dist_2);
+    float inv_dist_3 = inv_dist * inv_dist * inv_dist;
+    // fmax turns the NaN of coincident points (0 * infinity) into 0
+    float u = fmax(dist_2 * inv_dist, 0.0f) * inv_rad;
+    float inner = inv_rad_3 * (32.0f / 3.0f + u * u * (32.0f * u - 38.4f));
+    float outer = inv_rad_3 * (64.0f / 3.0f + u * (-48.0f + u * (38.4f - 32.0f / 3.0f * u))) - inv_dist_3 * (1.0f / 15.0f);
+    return select(select(inner, outer, isgreaterequal(u, 0.5f)), inv_dist_3, isgreaterequal(u, 1.0f));
+#else
+    float inv_dist = RSQRT(dist_2);
+    return select(0.0f, inv_dist * inv_dist * inv_dist, isgreater(dist_2, rad * rad));
+#endif
+}
+
+// Storage of the velocities and accelerations, two floats per point, or two halves with NBODY_HALF_STORAGE. Halves
+// hold the values in units of NBODY_VEL_UNIT and NBODY_ACC_UNIT, clamped to the largest finite half. The arithmetic
+// is float either way, vload_half2 and vstore_half2 are core OpenCL and need no half support from the device.
+// Kernels that only move the values copy the VECTOR_WORDS 32-bit words of a point instead of touching halves.
+#ifdef NBODY_HALF_STORAGE
+#define HALF_STORAGE_MAX 65504.0f
+#define VECTOR_STORAGE half
+#define LOAD_VECTOR(buffer, i, unit) (vload_half2((i), (buffer)) * (unit))
+#define STORE_VECTOR(value, buffer, i, unit) vstore_half2(clamp((value) / (unit), -HALF_STORAGE_MAX, HALF_STORAGE_MAX), (i), (buffer))
+#define VEL_UNIT NBODY_VEL_UNIT
+#define ACC_UNIT NBODY_ACC_UNIT
+#define VECTOR_WORDS 1
+#else
+#define VECTOR_STORAGE float
+#define LOAD_VECTOR(buffer, i, unit) vload2((i), (buffer))
+#define STORE_VECTOR(value, buffer, i, unit) vstore2((value), (i), (buffer))
+#define VEL_UNIT 1.0f
+#define ACC_UNIT 1.0f
+#define VECTOR_WORDS 2
+#endif
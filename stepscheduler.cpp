@@ -0,0 +1,32 @@
+#include <algorithm>
+#include <cmath>
+#include "stepscheduler.h"
+
+
+StepScheduler::StepScheduler(double frame_time, double busy_fraction, uint32_t max_steps) :
+    m_budget(frame_time * busy_fraction),
+    m_max_steps(std::max(max_steps, 1u))
+{
+}
+
+uint32_t StepScheduler::getNumSteps() const
+{
+    if (m_step_time <= 0.0) {
+        return 1;
+    }
+
+    const double num_steps = std::floor(m_budget / m_step_time);
+    const uint32_t max_steps = std::min(m_max_steps, m_last_num_steps * MAX_GROWTH);
+    return static_cast<uint32_t>(std::clamp(num_steps, 1.0, static_cast<double>(max_steps)));
+}
+
+void StepScheduler::addMeasurement(uint32_t num_steps, double elapsed_time)
+{
+    if (num_steps == 0) {
+        return;
+    }
+
+    const double step_time = elapsed_time / num_steps;
+    m_step_time = (m_step_time <= 0.0) ? step_time : (1.0 - SMOOTHING) * m_step_time + SMOOTHING * step_time;
+    m_last_num_steps = num_steps;
+}
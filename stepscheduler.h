@@ -0,0 +1,27 @@
+#ifndef STEPSCHEDULER_H
+#define STEPSCHEDULER_H
+
+#include <cstdint>
+
+// Picks how many simulation steps to batch per rendered frame, so that the simulation keeps a fixed share of
+// the frame time busy whatever the speed of the backend.
+class StepScheduler {
+public:
+    StepScheduler(double frame_time, double busy_fraction, uint32_t max_steps);
+
+    uint32_t getNumSteps() const;
+
+    // Elapsed time in seconds of a batch of num_steps steps, including the final synchronisation.
+    void addMeasurement(uint32_t num_steps, double elapsed_time);
+
+private:
+    static constexpr double SMOOTHING = 0.25; // weight of the newest measurement
+    static constexpr uint32_t MAX_GROWTH = 2; // the batch at most doubles from one frame to the next
+
+    double m_budget; // seconds per frame
+    uint32_t m_max_steps;
+    uint32_t m_last_num_steps = 1;
+    double m_step_time = 0.0; // smoothed seconds per step, 0 until measured
+};
+
+#endif // STEPSCHEDULER_H
@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <cmath>
+#include "symmetricsolver2d.h"
+
+
+SymmetricSolver2D::SymmetricSolver2D(ThreadPool& thread_pool, float attraction, float radius) :
+    m_thread_pool(thread_pool),
+    m_attraction(attraction),
+    m_radius(radius)
+{
+}
+
+
+void SymmetricSolver2D::computeAccelerations(const std::vector<float>& pos_x, const std::vector<float>& pos_y,
+    const std::vector<float>& mass, std::vector<float>& acc_x, std::vector<float>& acc_y)
+{
+    const size_t num_points = pos_x.size();
+    acc_x.resize(num_points);
+    acc_y.resize(num_points);
+
+    if (num_points == 0) {
+        return;
+    }
+
+    if (m_partial_x.empty() || (m_partial_x.front().size() != num_points)) {
+        partition(num_points);
+    }
+
+    // every partition runs its block pairs in order into its own buffers
+    m_thread_pool.parallelFor(m_partial_x.size(), [&](size_t begin, size_t end) {
+        for (size_t p = begin; p < end; p++) {
+            std::fill(m_partial_x[p].begin(), m_partial_x[p].end(), 0.0f);
+            std::fill(m_partial_y[p].begin(), m_partial_y[p].end(), 0.0f);
+            for (size_t k = m_partition_begins[p]; k < m_partition_begins[p + 1]; k++) {
+                blockPair(pos_x, pos_y, mass, m_block_pairs[k], m_partial_x[p].data(), m_partial_y[p].data());
+            }
+        }
+    });
+
+    // summed in partition order, independent of which thread ran which partition
+    m_thread_pool.parallelFor(num_points, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            float sum_x = 0.0f;
+            float sum_y = 0.0f;
+            for (size_t p = 0; p < m_partial_x.size(); p++) {
+                sum_x += m_partial_x[p][i];
+                sum_y += m_partial_y[p][i];
+            }
+
+            acc_x[i] = sum_x;
+            acc_y[i] = sum_y;
+        }
+    });
+}
+
+
+void SymmetricSolver2D::partition(size_t num_points)
+{
+    const uint32_t num_blocks = static_cast<uint32_t>((num_points + BLOCK_SIZE - 1) / BLOCK_SIZE);
+    m_block_pairs.clear();
+    for (uint32_t row = 0; row < num_blocks; row++) {
+        for (uint32_t column = row; column < num_blocks; column++) {
+            m_block_pairs.push_back({ row, column });
+        }
+    }
+
+    // a block with itself has half the pairs of two different blocks
+    const size_t num_partitions = std::min<size_t>(m_thread_pool.getNumThreads(), m_block_pairs.size());
+    const size_t total_work = m_block_pairs.size() * 2 - num_blocks;
+    m_partition_begins.assign(1, 0);
+    size_t work = 0;
+    for (size_t k = 0; k < m_block_pairs.size(); k++) {
+        work += (m_block_pairs[k].row == m_block_pairs[k].column) ? 1 : 2;
+        if ((work * num_partitions >= total_work * m_partition_begins.size()) && (m_partition_begins.size() < num_partitions)) {
+            m_partition_begins.push_back(k + 1);
+        }
+    }
+
+    m_partition_begins.push_back(m_block_pairs.size());
+    m_partial_x.assign(m_partition_begins.size() - 1, std::vector<float>(num_points));
+    m_partial_y.assign(m_partition_begins.size() - 1, std::vector<float>(num_points));
+}
+
+
+void SymmetricSolver2D::blockPair(const std::vector<float>& pos_x, const std::vector<float>& pos_y,
+    const std::vector<float>& mass, const BlockPair& block_pair, float* acc_x, float* acc_y) const
+{
+    const size_t num_points = pos_x.size();
+    const size_t row_begin = block_pair.row * BLOCK_SIZE;
+    const size_t row_end = std::min(row_begin + BLOCK_SIZE, num_points);
+    const size_t column_end = std::min((block_pair.column + 1) * BLOCK_SIZE, num_points);
+
+    for (size_t i = row_begin; i < row_end; i++) {
+        // within one block only the pairs above the diagonal
+        const size_t column_begin = (block_pair.row == block_pair.column) ? i + 1 : block_pair.column * BLOCK_SIZE;
+        const float x_i = pos_x[i];
+        const float y_i = pos_y[i];
+        const float mass_i = mass[i];
+        float sum_x = 0.0f;
+        float sum_y = 0.0f;
+
+        for (size_t j = column_begin; j < column_end; j++) {
+            const float dx = pos_x[j] - x_i;
+            const float dy = pos_y[j] - y_i;
+            const float dist = std::sqrt(dx * dx + dy * dy);
+            if (dist > m_radius) {
+                // the pair force divided by both masses, each point takes the mass of the other
+                const float factor = m_attraction / dist / dist / dist;
+                sum_x += mass[j] * factor * dx;
+                sum_y += mass[j] * factor * dy;
+                acc_x[j] -= mass_i * factor * dx;
+                acc_y[j] -= mass_i * factor * dy;
+            }
+        }
+
+        acc_x[i] += sum_x;
+        acc_y[i] += sum_y;
+    }
+}
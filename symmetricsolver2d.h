@@ -0,0 +1,39 @@
+#ifndef SYMMETRICSOLVER2D_H
+#define SYMMETRICSOLVER2D_H
+
+#include <cstdint>
+#include "forcesolver2d.h"
+
+// All-pairs solver that evaluates every unordered pair once and applies the force to both points, half the work
+// of the direct sum. The pairs are grouped into blocks of points, each partition of the block pairs accumulates
+// into its own buffers, and the buffers are summed in a fixed order so that the result does not depend on the
+// scheduling of the threads.
+class SymmetricSolver2D : public ForceSolver2D {
+public:
+    SymmetricSolver2D(ThreadPool& thread_pool, float attraction, float radius);
+
+    void computeAccelerations(const std::vector<float>& pos_x, const std::vector<float>& pos_y,
+        const std::vector<float>& mass, std::vector<float>& acc_x, std::vector<float>& acc_y) override;
+
+private:
+    static constexpr size_t BLOCK_SIZE = 256;
+
+    struct BlockPair {
+        uint32_t row;
+        uint32_t column; // not below the row
+    };
+
+    ThreadPool& m_thread_pool;
+    float m_attraction;
+    float m_radius;
+    std::vector<BlockPair> m_block_pairs;
+    std::vector<size_t> m_partition_begins; // first block pair of every partition, plus the end
+    std::vector<std::vector<float>> m_partial_x; // one per partition
+    std::vector<std::vector<float>> m_partial_y;
+
+    void partition(size_t num_points);
+    void blockPair(const std::vector<float>& pos_x, const std::vector<float>& pos_y, const std::vector<float>& mass,
+        const BlockPair& block_pair, float* acc_x, float* acc_y) const;
+};
+
+#endif // SYMMETRICSOLVER2D_H
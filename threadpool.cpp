@@ -0,0 +1,104 @@
+#include <algorithm>
+#include "threadpool.h"
+
+
+ThreadPool::ThreadPool(unsigned int num_threads)
+{
+    if (num_threads == 0) {
+        num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    for (unsigned int i = 1; i < num_threads; i++) {
+        m_threads.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_task_ready.notify_all();
+
+    for (std::thread& thread : m_threads) {
+        thread.join();
+    }
+}
+
+
+unsigned int ThreadPool::getNumThreads() const
+{
+    return static_cast<unsigned int>(m_threads.size()) + 1;
+}
+
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t begin, size_t end)>& task)
+{
+    if (count == 0) {
+        return;
+    }
+
+    if (m_threads.empty() || count == 1) {
+        task(0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_task_count = count;
+        m_chunk_size = std::max<size_t>(count / (getNumThreads() * CHUNKS_PER_THREAD), 1);
+        m_next_index = 0;
+        m_num_busy_threads = static_cast<unsigned int>(m_threads.size());
+        m_generation++;
+    }
+
+    m_task_ready.notify_all();
+    runChunks();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_task_done.wait(lock, [this] { return m_num_busy_threads == 0; });
+    m_task = nullptr;
+}
+
+
+void ThreadPool::workerLoop()
+{
+    uint64_t last_generation = 0;
+
+    for (;;) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_task_ready.wait(lock, [this, last_generation] { return m_stopping || (m_generation != last_generation); });
+        if (m_stopping) {
+            return;
+        }
+
+        last_generation = m_generation;
+        lock.unlock();
+
+        runChunks();
+
+        lock.lock();
+        m_num_busy_threads--;
+        if (m_num_busy_threads == 0) {
+            m_task_done.notify_all();
+        }
+    }
+}
+
+
+void ThreadPool::runChunks()
+{
+    for (;;) {
+        size_t begin = m_next_index.fetch_add(m_chunk_size);
+        if (begin >= m_task_count) {
+            return;
+        }
+
+        size_t end = std::min(begin + m_chunk_size, m_task_count);
+        (*m_task)(begin, end);
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    // Zero threads means one thread per hardware core. The calling thread counts as one of them.
+    explicit ThreadPool(unsigned int num_threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned int getNumThreads() const;
+
+    // Splits [0, count) into chunks, runs the task on all threads and returns when every chunk is done.
+    void parallelFor(size_t count, const std::function<void(size_t begin, size_t end)>& task);
+
+private:
+    static constexpr size_t CHUNKS_PER_THREAD = 4;
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_task_ready;
+    std::condition_variable m_task_done;
+    const std::function<void(size_t, size_t)>* m_task = nullptr;
+    size_t m_task_count = 0;
+    size_t m_chunk_size = 1;
+    std::atomic<size_t> m_next_index{ 0 };
+    unsigned int m_num_busy_threads = 0;
+    uint64_t m_generation = 0;
+    bool m_stopping = false;
+
+    void workerLoop();
+    void runChunks();
+};
+
+#endif // THREADPOOL_H